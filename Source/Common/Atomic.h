@@ -2,6 +2,8 @@
 
 #if defined(P3D_WINDOWS)
 #include "Windows/Atomic.h"
+#elif defined(P3D_POSIX)
+#include "Posix/Atomic.h"
 #endif
 
 namespace P3D
@@ -0,0 +1,266 @@
+#include "Includes.h"
+#include "BinaryFileAppender.h"
+#include "TimeCounter.h"
+#include "UtilFunctions.h"
+
+#if defined(P3D_POSIX)
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#endif
+
+namespace P3D
+{
+    namespace LogAppenders
+    {
+        using namespace BinaryLog;
+
+        BinaryFileAppender::BinaryFileAppender(const String& file)
+            : _view(NULL), _mappedSize(0), _end(0), _argCount(0)
+        {
+            if (!Open(file)) return;
+
+            FileHeader* header = (FileHeader*)Append(sizeof(FileHeader));
+            if (header == NULL) return;
+            header->Magic = Magic;
+            header->Version = Version;
+            header->TicksPerSecond = TimeCounter::GetTicksPerSecond();
+            header->StartTicks = TimeCounter::GetTickCount();
+            header->StartTime = int64(time(NULL));
+        }
+
+        BinaryFileAppender::~BinaryFileAppender()
+        {
+            Close();
+        }
+
+#if defined(P3D_WINDOWS)
+        bool BinaryFileAppender::Open(const String& file)
+        {
+            _mapping = NULL;
+            _file = CreateFileW(file.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+            return IsOpen();
+        }
+
+        bool BinaryFileAppender::IsOpen() const
+        {
+            return _file != INVALID_HANDLE_VALUE;
+        }
+
+        bool BinaryFileAppender::Map(uint64 size)
+        {
+            // mapping larger than the file extends it, new space is filled with zeros (Record_End)
+            _mapping = CreateFileMappingW(_file, NULL, PAGE_READWRITE, DWORD(size >> 32), DWORD(size), NULL);
+            if (_mapping == NULL) return false;
+            _view = (byte*)MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, 0);
+            return _view != NULL;
+        }
+
+        void BinaryFileAppender::Unmap()
+        {
+            if (_view)
+                UnmapViewOfFile(_view);
+            if (_mapping)
+                CloseHandle(_mapping);
+            _view = NULL;
+            _mapping = NULL;
+        }
+
+        void BinaryFileAppender::Close()
+        {
+            Unmap();
+            if (_file != INVALID_HANDLE_VALUE)
+            {
+                // cut unused part of the last chunk
+                LARGE_INTEGER size;
+                size.QuadPart = _end;
+                SetFilePointerEx(_file, size, NULL, FILE_BEGIN);
+                SetEndOfFile(_file);
+                CloseHandle(_file);
+            }
+            _file = INVALID_HANDLE_VALUE;
+        }
+#else
+        bool BinaryFileAppender::Open(const String& file)
+        {
+            _file = open(ToUTF8(file).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            return IsOpen();
+        }
+
+        bool BinaryFileAppender::IsOpen() const
+        {
+            return _file != -1;
+        }
+
+        bool BinaryFileAppender::Map(uint64 size)
+        {
+            // extended part of the file reads as zeros (Record_End)
+            if (ftruncate(_file, off_t(size)) != 0) return false;
+            void* view = mmap(NULL, size_t(size), PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+            if (view == MAP_FAILED) return false;
+            _view = (byte*)view;
+            return true;
+        }
+
+        void BinaryFileAppender::Unmap()
+        {
+            if (_view)
+                munmap(_view, size_t(_mappedSize));
+            _view = NULL;
+        }
+
+        void BinaryFileAppender::Close()
+        {
+            Unmap();
+            if (_file != -1)
+            {
+                // cut unused part of the last chunk
+                ftruncate(_file, off_t(_end));
+                close(_file);
+            }
+            _file = -1;
+        }
+#endif
+
+        bool BinaryFileAppender::Grow(uint size)
+        {
+            Unmap();
+
+            uint64 newSize = _mappedSize + ChunkSize;
+            while (newSize < _end + size) newSize += ChunkSize;
+
+            if (!Map(newSize))
+            {
+                Close();
+                return false;
+            }
+            _mappedSize = newSize;
+            return true;
+        }
+
+        byte* BinaryFileAppender::Append(uint size)
+        {
+            if (!IsOpen()) return NULL;
+            if (_end + size > _mappedSize && !Grow(size))
+                return NULL;
+
+            byte* data = _view + _end;
+            _end += size;
+            return data;
+        }
+
+        void BinaryFileAppender::WriteDefinition(RecordType type, uint32 id, const String& text)
+        {
+            uint length = text.length() < 0xFFFF ? text.length() : 0xFFFF;
+            byte* data = Append(1 + sizeof(SourceRecord) + length * sizeof(wchar));
+            if (data == NULL) return;
+
+            data[0] = byte(type);
+            SourceRecord* record = (SourceRecord*)(data + 1);
+            record->ID = id;
+            record->Length = uint16(length);
+            memcpy(record + 1, text.c_str(), length * sizeof(wchar));
+        }
+
+        uint32 BinaryFileAppender::GetSourceID(const wchar* source)
+        {
+            IDMap::iterator it = _sources.find(source);
+            if (it != _sources.end())
+                return it->second;
+
+            uint32 id = _sources.size();
+            _sources[source] = id;
+            WriteDefinition(Record_Source, id, source);
+            return id;
+        }
+
+        uint32 BinaryFileAppender::GetFormatID(const String& format)
+        {
+            IDMap::iterator it = _formats.find(format);
+            if (it != _formats.end())
+                return it->second;
+
+            if (_formats.size() >= MaxFormats)
+            {
+                WriteDefinition(Record_Format, InlineFormat, format);
+                return InlineFormat;
+            }
+
+            uint32 id = _formats.size();
+            _formats[format] = id;
+            WriteDefinition(Record_Format, id, format);
+            return id;
+        }
+
+        void BinaryFileAppender::ParseMessage(const wchar* msg)
+        {
+            _format.clear();
+            _argCount = 0;
+
+            const wchar* c = msg;
+            while (*c)
+            {
+                if (!iswdigit(*c))
+                {
+                    _format += *c++;
+                    continue;
+                }
+
+                const wchar* start = c;
+                while (iswdigit(*c)) c++;
+                uint digits = c - start;
+
+                // numbers with leading zeros can't be restored from value
+                if (_argCount < MaxArgs && digits <= MaxDigits && (digits == 1 || *start != '0'))
+                {
+                    uint64 value = 0;
+                    for (const wchar* d = start; d < c; d++)
+                        value = value * 10 + (*d - '0');
+                    _args[_argCount++] = value;
+                    _format += ArgPlaceholder;
+                } else
+                    _format.append(start, c);
+            }
+        }
+
+        void BinaryFileAppender::ProcessLogMessage(const LogMessage& msg)
+        {
+            if (!IsOpen()) return;
+
+            uint32 sourceID = GetSourceID(msg.Source);
+            ParseMessage(msg.Message);
+            uint32 formatID = GetFormatID(_format);
+
+            byte args[MaxArgs * 10];
+            uint argsSize = 0;
+            for (uint i = 0; i < _argCount; i++)
+                argsSize += WriteVarint(args + argsSize, _args[i]);
+
+            byte* data = Append(1 + sizeof(MessageRecord) + argsSize);
+            if (data == NULL) return;
+
+            data[0] = Record_Message;
+            MessageRecord* record = (MessageRecord*)(data + 1);
+            record->Level = byte(msg.Level);
+            record->ArgCount = byte(_argCount);
+            record->ThreadID = msg.ThreadID;
+            record->SourceID = sourceID;
+            record->FormatID = formatID;
+            record->Timestamp = msg.Timestamp;
+            memcpy(record + 1, args, argsSize);
+        }
+
+        LogAppender* BinaryFileAppender::CreateFromXMLDefenition(TiXmlElement* defenition)
+        {
+            String file;
+            const char* fileAttr = defenition->Attribute("file");
+            if (fileAttr != NULL)
+                file = ToUTF16(fileAttr);
+            else
+                file = L"Log.bin";
+
+            return new BinaryFileAppender(file);
+        }
+    }
+}
\ No newline at end of file
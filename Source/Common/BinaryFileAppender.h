@@ -0,0 +1,103 @@
+#pragma once
+
+#include "LogAppender.h"
+#include "BinaryLogFormat.h"
+
+namespace P3D
+{
+    namespace LogAppenders
+    {
+        /*
+        Writes log in compact binary format (see BinaryLogFormat.h) to memory mapped file.
+        Sources and message formats are interned, numbers are packed as varints,
+        time is written as raw counter value. Use LogDecoder to get text log.
+        File is written by the system even if the process crashes.
+        */
+        class BinaryFileAppender : public LogAppender
+        {
+        public:
+            static LogAppender* CreateFromXMLDefenition(TiXmlElement* defenition);
+
+            BinaryFileAppender(const String& file);
+            virtual ~BinaryFileAppender();
+
+            override void ProcessLogMessage(const LogMessage& msg);
+
+        protected:
+            enum
+            {
+                ChunkSize = 4 * 1024 * 1024, // file grows by this size
+                MaxFormats = 65536, // messages are written as is when format table is full
+                MaxArgs = 32,
+                MaxDigits = 18 // longer numbers stay in format
+            };
+
+            /*
+            Return ID of the source, write source record on the first use.
+            */
+            uint32 GetSourceID(const wchar* source);
+
+            /*
+            Return ID of the format, write format record on the first use.
+            */
+            uint32 GetFormatID(const String& format);
+
+            /*
+            Split message into format and number arguments.
+            */
+            void ParseMessage(const wchar* msg);
+
+            /*
+            Write record of type with fixed part and text.
+            */
+            void WriteDefinition(BinaryLog::RecordType type, uint32 id, const String& text);
+
+            /*
+            Return pointer to size bytes at the end of the log and move end after them.
+            Return NULL in case file can't be grown.
+            */
+            byte* Append(uint size);
+
+            /*
+            Remap the file so it has at least size bytes after the end.
+            */
+            bool Grow(uint size);
+
+            // Platform specific part
+
+            bool Open(const String& file);
+            bool IsOpen() const;
+
+            /*
+            Extend the file to size bytes and map it whole into _view.
+            */
+            bool Map(uint64 size);
+            void Unmap();
+
+            /*
+            Unmap the file, cut it to _end bytes and close it.
+            */
+            void Close();
+
+        protected:
+#if defined(P3D_WINDOWS)
+            HANDLE _file;
+            HANDLE _mapping;
+#else
+            int _file;
+#endif
+            byte* _view;
+            uint64 _mappedSize;
+            uint64 _end;
+
+            typedef std::map<String, uint32> IDMap;
+            IDMap _sources;
+            IDMap _formats;
+
+            // parsed message, reused between messages
+            String _format;
+            uint64 _args[MaxArgs];
+            uint _argCount;
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+namespace P3D
+{
+    /*
+    Format of the binary log written by BinaryFileAppender and read by LogDecoder.
+    File starts with FileHeader followed by records. Each record starts with RecordType byte.
+    Sources and message formats are written once as definition records and then
+    referenced by ID. Format is the message text with decimal numbers replaced by
+    ArgPlaceholder, the numbers are stored in the message record as varints.
+    Zero record type marks the end of the file (unused space of the mapped file).
+    */
+    namespace BinaryLog
+    {
+        const uint32 Magic = 0x4C443350; // 'P3DL'
+        const uint32 Version = 1;
+
+        // stands for a number argument in message format
+        const wchar ArgPlaceholder = 1;
+
+        // format ID redefined before each message when format table is full
+        const uint32 InlineFormat = 0xFFFFFFFF;
+
+        enum RecordType
+        {
+            Record_End = 0,
+            Record_Source, // SourceRecord, wchar[Length]
+            Record_Format, // FormatRecord, wchar[Length]
+            Record_Message // MessageRecord, varint[ArgCount]
+        };
+
+    #pragma pack(push, 1)
+        struct FileHeader
+        {
+            uint32 Magic;
+            uint32 Version;
+            uint64 TicksPerSecond; // frequency of message timestamps
+            uint64 StartTicks; // timestamp at StartTime
+            int64 StartTime; // time_t when the log was started
+        };
+
+        struct SourceRecord
+        {
+            uint32 ID;
+            uint16 Length;
+        };
+
+        typedef SourceRecord FormatRecord;
+
+        struct MessageRecord
+        {
+            byte Level;
+            byte ArgCount;
+            uint32 ThreadID;
+            uint32 SourceID;
+            uint32 FormatID;
+            uint64 Timestamp;
+        };
+    #pragma pack(pop)
+
+        /*
+        Write value as varint (7 bits per byte, high bit means continuation).
+        Return count of written bytes, buffer should have at least 10 bytes.
+        */
+        inline uint WriteVarint(byte* buffer, uint64 value)
+        {
+            uint size = 0;
+            while (value >= 0x80)
+            {
+                buffer[size++] = byte(value | 0x80);
+                value >>= 7;
+            }
+            buffer[size++] = byte(value);
+            return size;
+        }
+
+        /*
+        Read varint. Return count of read bytes, 0 if the buffer ends before the value.
+        */
+        inline uint ReadVarint(const byte* buffer, uint available, uint64* value)
+        {
+            *value = 0;
+            for (uint i = 0; i < available && i < 10; i++)
+            {
+                *value |= uint64(buffer[i] & 0x7F) << (7 * i);
+                if ((buffer[i] & 0x80) == 0)
+                    return i + 1;
+            }
+            return 0;
+        }
+    }
+}
\ No newline at end of file
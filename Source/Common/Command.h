@@ -3,6 +3,8 @@
 #include "Logger.h"
 #include "Object.h"
 #include "Boxed.h"
+#include "MPSCQueue.h"
+#include "CommandAllocator.h"
 
 namespace P3D
 {
@@ -11,14 +13,76 @@ namespace P3D
 
     /*
     Command that can be invoked.
+    Can be put into MPSCQueue without allocations, one queue at a time.
+    Commands memory comes from per-thread caches of CommandAllocator, not from the heap.
     */
     class Command 
-        : public Object
+        : public Object,
+          public MPSCQueueNode
     {
     public:
+        Command() : _completion(NULL), _discarded(false)
+        { }
+
         virtual void Execute(ExecutionContext* context) = 0;
+
+        /*
+        Called instead of Execute when the context drops the command (e.g. on stop).
+        Commands that should finish something anyway override it.
+        */
+        virtual void Discard()
+        { }
+
+        /*
+        Signal the event of InvokeOverlapped. Contexts call it right after Execute,
+        or with executed == false when they drop the command without executing it.
+        */
+        void SignalCompletion(bool executed)
+        {
+            if (_completion == NULL) return;
+            _discarded = !executed;
+            _completion->Unbox().Signal();
+            _completion->Release();
+            _completion = NULL;
+        }
+
+        static void* operator new(size_t size) { return CommandAllocator::Allocate(size); }
+        static void operator delete(void* block, size_t size) { CommandAllocator::Free(block, size); }
+
+    protected:
+        virtual ~Command()
+        {
+            // released without notice, don't leave waiters hanging
+            SignalCompletion(false);
+        }
+
+    private:
+        friend class ExecutionContext;
+
+        // signaled after execution, see InvokeOverlapped
+        Boxed<ManualEvent>* _completion;
+        bool _discarded; // completion was signaled without execution
     };
 
+    /*
+    Release the command that will not be executed, waiters get Stopped.
+    */
+    inline void DiscardCommand(Command* command)
+    {
+        command->Discard();
+        command->SignalCompletion(false);
+        command->Release();
+    }
+
+    /*
+    Discard all commands left in the queue.
+    */
+    inline void DiscardCommands(MPSCQueue<Command>& queue)
+    {
+        while (Command* command = queue.Peek())
+            DiscardCommand(command);
+    }
+
     /*
     Object that can execute commands.
     */
@@ -40,18 +104,27 @@ namespace P3D
 
         /*
         Invokes command and return Boxed<ManualEvent> that will be in signaled state when command finish execution.
-        It should be released manually.
+        Event is signaled by the context right after Execute (or when it discards the command),
+        no wrapper command is allocated.
+        Doesn't take ownership of the command. Event should be released manually.
         */
         Boxed<ManualEvent>* InvokeOverlapped(Command* command)
         {
             ASSERT(command != NULL);
+            ASSERT(command->_completion == NULL); // one overlapped invocation at a time
             Boxed<ManualEvent>* waitEvent = CreateObjectInPool<Boxed<ManualEvent> >();
-            Invoke(new ExecuteAndSignalEvent(command, waitEvent));
+            waitEvent->AddRef(); // released on completion
+            command->_completion = waitEvent;
+            command->_discarded = false;
+            command->AddRef(); // released by the context
+            Invoke(command);
             return waitEvent;
         }
 
         /*
         Invokes command and waits till it is finished.
+        Doesn't take ownership of the command, results can be read from it after the call.
+        Return Stopped if the context discarded the command.
         */
         InvokationResult InvokeAndWait(Command* command, uint timeout = INFINITE, Event* stopEvent = NULL)
         {
@@ -74,34 +147,11 @@ namespace P3D
                 else
                     res = Executed;
             }
+            if (res == Executed && command->_discarded)
+                res = Stopped;
             waitEvent->Release();
             return res;
         }
-
-    private:
-        class ExecuteAndSignalEvent : 
-            public Command
-        {
-        public:
-            ExecuteAndSignalEvent(Command* cmd, Boxed<ManualEvent>* signal) : _cmd(cmd), _signal(signal)
-            {
-                _cmd->AddRef();
-                _signal->AddRef();
-            }
-            virtual ~ExecuteAndSignalEvent()
-            {
-                _signal->Release();
-                _cmd->Release();
-            }
-            override void Execute(ExecutionContext* cmdHandler)
-            {
-                _cmd->Execute(cmdHandler);
-                _signal->Unbox().Signal();
-            }
-        private:
-            Command* _cmd;
-            Boxed<ManualEvent>* _signal;
-        };
     };
 
     static ExecutionContext* CONTEXT_CALL_NOW       = 0;
@@ -136,7 +186,7 @@ namespace P3D
             else
             {
                 LoggingSystem::GetInstance().Message(L"Special context is not defined!", LOG_ERROR, L"System.Invoke");
-                cmd->Release();
+                DiscardCommand(cmd);
             }
         }
     }
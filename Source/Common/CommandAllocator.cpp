@@ -0,0 +1,129 @@
+#include "Includes.h"
+#include "CommandAllocator.h"
+#include <malloc.h>
+
+namespace P3D
+{
+    ThreadLocal<CommandAllocator::ThreadCache> CommandAllocator::_cache;
+    ProfiledLock<SpinLock> CommandAllocator::_depotLock("CommandAllocator.Depot");
+    CommandAllocator::Block* CommandAllocator::_depot[CommandAllocator::ClassCount];
+
+    CommandAllocator::ThreadCache* CommandAllocator::GetThreadCache()
+    {
+        ThreadCache* cache = _cache.Get();
+        if (cache == NULL)
+        {
+            cache = new ThreadCache();
+            memset(cache, 0, sizeof(ThreadCache));
+            _cache.Set(cache);
+        }
+        return cache;
+    }
+
+    void* CommandAllocator::Allocate(size_t size)
+    {
+        uint cls = GetClass(size);
+        if (cls >= ClassCount)
+            return ::operator new(size);
+
+        ThreadCache* cache = GetThreadCache();
+        if (cache->Free[cls] == NULL)
+            Refill(cache, cls);
+
+        Block* block = cache->Free[cls];
+        cache->Free[cls] = block->Next;
+        cache->Count[cls]--;
+        return block;
+    }
+
+    void CommandAllocator::Free(void* block, size_t size)
+    {
+        if (block == NULL) return;
+
+        uint cls = GetClass(size);
+        if (cls >= ClassCount)
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        ThreadCache* cache = GetThreadCache();
+        Block* b = (Block*)block;
+        b->Next = cache->Free[cls];
+        cache->Free[cls] = b;
+        if (++cache->Count[cls] > CacheLimit)
+            Flush(cache, cls, BatchSize);
+    }
+
+    void CommandAllocator::Refill(ThreadCache* cache, uint cls)
+    {
+        auto_lock(_depotLock)
+        {
+            uint count = 0;
+            Block* last = _depot[cls];
+            while (last && count < BatchSize - 1 && last->Next)
+            {
+                last = last->Next;
+                count++;
+            }
+            if (last)
+            {
+                cache->Free[cls] = _depot[cls];
+                cache->Count[cls] = count + 1;
+                _depot[cls] = last->Next;
+                last->Next = NULL;
+                return;
+            }
+        }
+
+        // depot is empty, carve new chunk
+        // chunks are never returned to the heap: commands memory is reused for the whole run
+        size_t blockSize = (cls + 1) * Granularity;
+        char* chunk = (char*)_aligned_malloc(blockSize * BatchSize, Granularity);
+        if (chunk == NULL)
+            throw std::bad_alloc();
+
+        Block* head = NULL;
+        for (int i = BatchSize - 1; i >= 0; i--)
+        {
+            Block* b = (Block*)(chunk + i * blockSize);
+            b->Next = head;
+            head = b;
+        }
+        cache->Free[cls] = head;
+        cache->Count[cls] = BatchSize;
+    }
+
+    void CommandAllocator::Flush(ThreadCache* cache, uint cls, uint count)
+    {
+        Block* first = cache->Free[cls];
+        if (first == NULL || count == 0) return;
+
+        Block* last = first;
+        uint taken = 1;
+        while (taken < count && last->Next)
+        {
+            last = last->Next;
+            taken++;
+        }
+        cache->Free[cls] = last->Next;
+        cache->Count[cls] -= taken;
+
+        auto_lock(_depotLock)
+        {
+            last->Next = _depot[cls];
+            _depot[cls] = first;
+        }
+    }
+
+    void CommandAllocator::ReleaseThreadCache()
+    {
+        ThreadCache* cache = _cache.Get();
+        if (cache == NULL) return;
+
+        for (uint cls = 0; cls < ClassCount; cls++)
+            Flush(cache, cls, cache->Count[cls]);
+        _cache.Set(NULL);
+        delete cache;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Synchronization.h"
+#include "LockProfiler.h"
+#include "ThreadLocal.h"
+
+namespace P3D
+{
+    /*
+    Allocator of small blocks for commands.
+    Each thread keeps cache of free blocks per size class so steady-state
+    allocation and deallocation don't touch the heap or locks.
+    Caches exchange batches of blocks through the global depot:
+    command allocated in one thread and released in another migrates back eventually.
+    Blocks are aligned to Granularity.
+    */
+    class CommandAllocator
+    {
+    public:
+        enum
+        {
+            Granularity = 32, // block size step and alignment
+            ClassCount = 8, // blocks up to Granularity * ClassCount bytes are cached
+            BatchSize = 32, // blocks moved between thread cache and depot at once
+            CacheLimit = 2 * BatchSize // max free blocks of one class in thread cache
+        };
+
+        /*
+        Allocate block of at least size bytes.
+        */
+        static void* Allocate(size_t size);
+
+        /*
+        Free block allocated by Allocate. Size should be the same.
+        */
+        static void Free(void* block, size_t size);
+
+        /*
+        Return blocks cached by the calling thread to the depot.
+        Called when thread finishes.
+        */
+        static void ReleaseThreadCache();
+
+    private:
+        struct Block
+        {
+            Block* Next;
+        };
+
+        struct ThreadCache
+        {
+            Block* Free[ClassCount];
+            uint Count[ClassCount];
+        };
+
+        /*
+        Return size class for block size. ClassCount for blocks that are not cached.
+        */
+        static inline uint GetClass(size_t size) { return (uint)((size + Granularity - 1) / Granularity) - 1; }
+
+        static ThreadCache* GetThreadCache();
+
+        /*
+        Take batch of blocks from the depot or allocate new chunk.
+        */
+        static void Refill(ThreadCache* cache, uint cls);
+
+        /*
+        Move batch of blocks from the thread cache to the depot.
+        */
+        static void Flush(ThreadCache* cache, uint cls, uint count);
+
+        static ThreadLocal<ThreadCache> _cache;
+        static ProfiledLock<SpinLock> _depotLock; // held for a few pointer moves only
+        static Block* _depot[ClassCount];
+    };
+}
\ No newline at end of file
@@ -1,81 +1,187 @@
 #include "Includes.h"
 #include "Config.h"
 #include "Logger.h"
+#include "Thread.h"
+#include <sys/stat.h>
 
 namespace P3D
 {
     DEFINE_SINGLETON(Config);
     Logger Config::logger(L"System.Config");
 
-    Config::Config(const String& conf)
+    /*
+    Polls modification time of the config file from the main loop.
+    */
+    class Config::Watcher :
+        public MainThreadListener
     {
-        AutoLock lock(_lock);
+    public:
+        Watcher(Config* config, uint interval)
+            : _config(config), _interval(interval), _lastCheck(SDL_GetTicks())
+        { }
+
+        override void OnIdle()
+        {
+            uint now = SDL_GetTicks();
+            if (now - _lastCheck < _interval) return;
+            _lastCheck = now;
+
+            time_t modified = _config->GetModificationTime();
+            if (modified != 0 && modified != _config->_modificationTime)
+            {
+                _config->logger.info() << L"Config file changed, reloading.";
+                _config->Reload();
+            }
+        }
+
+    private:
+        Config* _config;
+        uint _interval;
+        uint _lastCheck;
+    };
 
+    Config::Config(const String& conf)
+        : _retired(NULL), _modificationTime(0), _watcher(NULL)
+    {
         if (conf.empty())
             _filePath = L"config.xml";
         else
             _filePath = conf;
 
+        // readers always get a snapshot, empty one if there is no file
+        _snapshot = new Snapshot();
+
         Reload();
     }
 
     Config::~Config()
     {
+        StopWatching();
+        delete _retired;
+        delete _snapshot;
     }
 
     void Config::Reload()
     {
-        AutoLock lock(_lock);
+        {
+            AutoLock lock(_reloadLock);
+            time_t modified = GetModificationTime();
+            FILE* file = _wfopen(_filePath.c_str(), L"rb");
+            if (file == NULL) return;
+            Snapshot* snapshot = new Snapshot();
+            bool loaded = snapshot->Document.LoadFile(file);
+            fclose(file);
+            _modificationTime = modified;
 
-        FILE* file = _wfopen(_filePath.c_str(), L"rb");
-        if (file == NULL) return;
-        _config.Clear();
-        _config.LoadFile(file);
-        fclose(file);
+            if (!loaded)
+            {
+                logger.warn() << L"Failed to parse " << _filePath << L": " 
+                    << ToUTF16(snapshot->Document.ErrorDesc()) << L". Keeping previous values.";
+                delete snapshot;
+                return;
+            }
+
+            Compile(snapshot);
+            Snapshot* old = (Snapshot*)AtomicExchangePointer((void* volatile*)&_snapshot, snapshot);
+
+            // reads are short and reloads are rare: nobody reads the snapshot
+            // replaced one reload ago anymore, the one replaced now may still be read
+            delete _retired;
+            _retired = old;
+        }
+
+        DispatchEvent(&ConfigListener::OnConfigChanged);
+    }
+
+    void Config::Compile(Snapshot* snapshot)
+    {
+        TiXmlElement* root = snapshot->Document.RootElement();
+        if (root == NULL) return;
+        for (const TiXmlElement* section = root->FirstChildElement(); section; section = section->NextSiblingElement())
+        {
+            // first section with the name wins, like FirstChildElement
+            if (snapshot->Sections.find(section->Value()) != snapshot->Sections.end()) continue;
+            ValueMap& values = snapshot->Sections[section->Value()];
+            for (const TiXmlAttribute* attr = section->FirstAttribute(); attr; attr = attr->Next())
+            {
+                Value& value = values[attr->Name()];
+                value.Text = attr->Value();
+                value.WideText = ToUTF16(value.Text);
+                value.IsInt = (sscanf(attr->Value(), "%d", &value.Int) == 1);
+                value.IsBool = true;
+                if (strcmpi(attr->Value(), "true") == 0)
+                    value.Bool = true;
+                else if (strcmpi(attr->Value(), "false") == 0)
+                    value.Bool = false;
+                else
+                    value.IsBool = false;
+            }
+        }
+    }
+
+    time_t Config::GetModificationTime() const
+    {
+        struct _stat info;
+        if (_wstat(_filePath.c_str(), &info) != 0) return 0;
+        return info.st_mtime;
+    }
+
+    void Config::StartWatching()
+    {
+        if (_watcher || !ReadBool("ConfigWatch", "enabled", false)) return;
+        _watcher = new Watcher(this, ReadInt("ConfigWatch", "interval", 1000));
+        Thread::GetMainThread()->AddListener(_watcher);
+    }
+
+    void Config::StopWatching()
+    {
+        if (_watcher == NULL) return;
+        Thread::GetMainThread()->RemoveListener(_watcher);
+        delete _watcher;
+        _watcher = NULL;
     }
 
     const TiXmlElement* Config::GetSection(const char* section)
     {
-        AutoLock lock(_lock);
-        TiXmlElement* root = _config.RootElement();
+        TiXmlElement* root = _snapshot->Document.RootElement();
         if (root == NULL) return NULL;
         return root->FirstChildElement(section);
     }
 
+    const Config::Value* Config::Find(const Snapshot* snapshot, const std::string& section, const std::string& name)
+    {
+        const SectionMap& sections = snapshot->Sections;
+        SectionMap::const_iterator values = sections.find(section);
+        if (values == sections.end()) return NULL;
+        ValueMap::const_iterator value = values->second.find(name);
+        if (value == values->second.end()) return NULL;
+        return &value->second;
+    }
+
     const std::string Config::ReadAnsiString(const std::string& section, 
         const std::string& name, const std::string& def)
     {
-        const TiXmlElement* tag = GetSection(section.c_str());
-        if (tag == NULL) return def;
-        const char* attr = tag->Attribute(name.c_str());
-        if (attr == NULL) return def;
-        else return attr;
+        const Value* value = Find(_snapshot, section, name);
+        return value ? value->Text : def;
     }
 
     const String Config::ReadWideString(const std::string& section, 
         const std::string& name, const String& def)
     {
-        const TiXmlElement* tag = GetSection(section.c_str());
-        if (tag == NULL) return def;
-        const char* attr = tag->Attribute(name.c_str());
-        if (attr == NULL) return def;
-        else return ToUTF16(attr);
+        const Value* value = Find(_snapshot, section, name);
+        return value ? value->WideText : def;
     }
 
     int Config::ReadInt(const std::string& section, 
         const std::string& name, int def)
     {
-        const TiXmlElement* tag = GetSection(section.c_str());
-        if (tag == NULL) return def;
-        int value = def;
-        tag->QueryIntAttribute(name.c_str(), &value);
-        return value;
+        const Value* value = Find(_snapshot, section, name);
+        return (value && value->IsInt) ? value->Int : def;
     }
 
     bool Config::ReadBool(const std::string& section, const std::string& name, bool def)
     {
-        const TiXmlElement* tag = GetSection(section.c_str());
-        if (tag == NULL) return def;
-        return XmlReadBool(tag, name.c_str(), def);
+        const Value* value = Find(_snapshot, section, name);
+        return (value && value->IsBool) ? value->Bool : def;
     }
 }
\ No newline at end of file
@@ -2,12 +2,32 @@
 
 #include "Logger.h"
 #include "Singleton.h"
-#include "Synchronization.h"
+#include "Observable.h"
 
 namespace P3D
 {
+    /*
+    Receives notifications about config changes.
+    */
+    class ConfigListener
+    {
+    public:
+        /*
+        Config file has been changed and reloaded.
+        */
+        virtual void OnConfigChanged() {}
+    };
+
+    /*
+    Engine settings from config.xml.
+    File is compiled on load into immutable snapshot of typed values,
+    reads take the current snapshot without locking and don't touch XML.
+    Reload replaces the snapshot and notifies listeners. Replaced snapshot is freed
+    by the next Reload, so reads that took it meanwhile stay valid without counting readers.
+    */
     class Config :
-        private Singleton<Config>
+        private Singleton<Config>,
+        public Observable<ConfigListener>
     {
         friend class Singleton<Config>;
         static Logger logger;
@@ -22,10 +42,23 @@ namespace P3D
             return Singleton<Config>::GetInstance();
         }
 
+        /*
+        Return config section. Returned element is valid till the Reload after the next one.
+        */
         const TiXmlElement* GetSection(const char* section);
 
+        /*
+        Load config file and publish it, keep current values if the file can't be read.
+        */
         void Reload();
 
+        /*
+        Check the config file for changes in the main loop and reload it when it is modified.
+        Controlled by <ConfigWatch enabled interval> section.
+        */
+        void StartWatching();
+        void StopWatching();
+
         /*
         Reads attribute from config section.
         */
@@ -35,8 +68,38 @@ namespace P3D
         bool              ReadBool(const std::string& section, const std::string& name, bool def = false);
 
     private:
-        TiXmlDocument _config;
-        Lock _lock;
+        class Watcher;
+        friend class Watcher;
+
+        // Attribute parsed to all types it can be read as
+        struct Value
+        {
+            std::string Text;
+            String WideText;
+            int Int;
+            bool IsInt;
+            bool Bool;
+            bool IsBool;
+        };
+
+        typedef std::map<std::string, Value> ValueMap;
+        typedef std::map<std::string, ValueMap> SectionMap;
+
+        struct Snapshot
+        {
+            TiXmlDocument Document;
+            SectionMap Sections;
+        };
+
+        void Compile(Snapshot* snapshot);
+        static const Value* Find(const Snapshot* snapshot, const std::string& section, const std::string& name);
+        time_t GetModificationTime() const;
+
+        Snapshot* volatile _snapshot;
+        Snapshot* _retired; // replaced by the last Reload, freed by the next one
+        Lock _reloadLock; // serializes writers only
+        time_t _modificationTime;
         String _filePath;
+        Watcher* _watcher;
     };
 }
\ No newline at end of file
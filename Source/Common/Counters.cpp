@@ -3,12 +3,22 @@
 
 namespace P3D
 {
-    int g_PolygonCounter = 0;
-    int g_QuaternionToMatrixConversion = 0;
-    int g_MatrixToQuaternionConversion = 0;
-    int g_MatrixMultiply = 0;
-    int g_MatrixInverse = 0;
-    int g_QuaternionMultiply = 0;
-    int g_VectorMatrixTransform = 0;
-    int g_EntitiesRendered = 0;
+    Counter g_PolygonCounter("Graphics.Polygons", "polygons");
+    Counter g_EntitiesRendered("World.EntitiesRendered", "entities");
+
+    Counter g_QuaternionToMatrixConversion("Math.QuaternionToMatrixConversions", "conversions");
+    Counter g_MatrixToQuaternionConversion("Math.MatrixToQuaternionConversions", "conversions");
+    Counter g_MatrixMultiply("Math.MatrixMultiplications", "multiplications");
+    Counter g_MatrixInverse("Math.MatrixInversions", "inversions");
+    Counter g_QuaternionMultiply("Math.QuaternionMultiplications", "multiplications");
+    Counter g_VectorMatrixTransform("Math.VectorTransforms", "transforms");
+
+    Gauge g_PhysicsStepTime("Physics.StepTime", "us");
+    Gauge g_PhysicsBroadphaseTime("Physics.BroadphaseTime", "us");
+    Gauge g_PhysicsNarrowphaseTime("Physics.NarrowphaseTime", "us");
+    Gauge g_PhysicsSolverTime("Physics.SolverTime", "us");
+    Gauge g_PhysicsIntegrationTime("Physics.IntegrationTime", "us");
+    Gauge g_PhysicsPairs("Physics.Pairs", "pairs");
+    Gauge g_PhysicsContacts("Physics.Contacts", "contacts");
+    Histogram g_PhysicsStepTimes("Physics.StepTimes", "us");
 }
\ No newline at end of file
@@ -1,27 +1,29 @@
 #pragma once
 
+#include "Metrics.h"
+
 namespace P3D
 {
-    extern int g_PolygonCounter;
-    extern int g_QuaternionToMatrixConversion;
-    extern int g_MatrixToQuaternionConversion;
-    extern int g_MatrixMultiply;
-    extern int g_MatrixInverse;
-    extern int g_QuaternionMultiply;
-    extern int g_VectorMatrixTransform;
-    extern int g_EntitiesRendered;
+    // rendering statistics, reported per frame by Metrics::EndFrame
+    extern Counter g_PolygonCounter;
+    extern Counter g_EntitiesRendered;
 
-    inline void IncCounter(int& c) { c++; }
+    // math operations statistics
+    extern Counter g_QuaternionToMatrixConversion;
+    extern Counter g_MatrixToQuaternionConversion;
+    extern Counter g_MatrixMultiply;
+    extern Counter g_MatrixInverse;
+    extern Counter g_QuaternionMultiply;
+    extern Counter g_VectorMatrixTransform;
 
-    inline void ClearCounters()
-    {
-        g_PolygonCounter = 0;
-        g_QuaternionToMatrixConversion = 0;
-        g_MatrixToQuaternionConversion = 0;
-        g_MatrixMultiply = 0;
-        g_MatrixInverse = 0;
-        g_QuaternionMultiply = 0;
-        g_VectorMatrixTransform = 0;
-        g_EntitiesRendered = 0;
-    }
+    // physics step statistics, times are in microseconds.
+    // Assigned by physical world on each step.
+    extern Gauge g_PhysicsStepTime;
+    extern Gauge g_PhysicsBroadphaseTime;
+    extern Gauge g_PhysicsNarrowphaseTime;
+    extern Gauge g_PhysicsSolverTime;
+    extern Gauge g_PhysicsIntegrationTime;
+    extern Gauge g_PhysicsPairs;
+    extern Gauge g_PhysicsContacts;
+    extern Histogram g_PhysicsStepTimes;
 }
\ No newline at end of file
@@ -1,22 +1,40 @@
 #pragma once
 
+#if !defined(_MSC_VER)
+#include <stdint.h>
+#endif
+
 namespace P3D
 {
     typedef unsigned char       byte;
     typedef signed char         sbyte;
     typedef unsigned short      ushort;
+    typedef unsigned int        uint;
+    typedef unsigned long       ulong;
+#if defined(_MSC_VER)
     typedef unsigned __int16    uint16;
     typedef __int16             int16;
-    typedef unsigned int        uint;
     typedef unsigned __int32    uint32;
     typedef __int32             int32;
-    typedef unsigned long       ulong;
     typedef unsigned __int64    uint64;
     typedef __int64             int64;
+#else
+    typedef uint16_t            uint16;
+    typedef int16_t             int16;
+    typedef uint32_t            uint32;
+    typedef int32_t             int32;
+    typedef uint64_t            uint64;
+    typedef int64_t             int64;
+#endif
     typedef wchar_t             wchar;
     typedef float               float32;
     typedef double              float64;
 
     typedef std::basic_string<wchar, std::char_traits<wchar>, std::allocator<wchar> > String;
     typedef void (*TagDisposeFunction)(void* tag);
-}
\ No newline at end of file
+}
+
+// Compile-time check, declaration fails to compile when expr is false.
+#define STATIC_ASSERT_JOIN2(a, b) a##b
+#define STATIC_ASSERT_JOIN(a, b) STATIC_ASSERT_JOIN2(a, b)
+#define STATIC_ASSERT(expr) typedef char STATIC_ASSERT_JOIN(StaticAssert, __LINE__)[(expr) ? 1 : -1]
\ No newline at end of file
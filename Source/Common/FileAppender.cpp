@@ -9,6 +9,8 @@ namespace P3D
         FileAppender::FileAppender(const String& file, bool append)
         {
             _file = _wfopen(file.c_str(), append ? L"at" : L"wt");
+            if (_file != NULL)
+                setvbuf(_file, NULL, _IOFBF, BufferSize);
         }
 
         FileAppender::~FileAppender()
@@ -20,10 +22,13 @@ namespace P3D
         void FileAppender::ProcessLogMessage(const LogMessage& msg)
         {
             if (_file != NULL)
-            {
                 fputws (msg.Formated(), _file);
+        }
+
+        void FileAppender::Flush()
+        {
+            if (_file != NULL)
                 fflush(_file);
-            }
         }
 
         LogAppender* FileAppender::CreateFromXMLDefenition(TiXmlElement* defenition)
@@ -8,6 +8,7 @@ namespace P3D
     {
         /*
         Writes log to the text file.
+        Output is buffered and written on Flush.
         */
         class FileAppender : public LogAppender
         {
@@ -18,8 +19,11 @@ namespace P3D
             virtual ~FileAppender();
 
             override void ProcessLogMessage(const LogMessage& msg);
+            override void Flush();
 
         protected:
+            enum { BufferSize = 64 * 1024 };
+
             FILE* _file;
         };
     }
@@ -0,0 +1,65 @@
+#include "Includes.h"
+#include "FrameArena.h"
+#include <malloc.h>
+
+namespace P3D
+{
+    ThreadLocal<FrameArena::Arena> FrameArena::_arena;
+    volatile long FrameArena::_frame = 0;
+
+    static Counter g_FrameArenaBytes("Memory.FrameArena", "bytes");
+    static Counter g_FrameArenaHeapAllocations("Memory.FrameArenaHeapAllocations", "allocations");
+
+    FrameArena::Arena* FrameArena::CreateArena()
+    {
+        // arenas are never deleted, like thread shards of metrics
+        Arena* arena = new Arena();
+        arena->Base = (char*)_aligned_malloc(InitialBlockSize, Alignment);
+        arena->Top = arena->Base;
+        arena->End = arena->Base + InitialBlockSize;
+        arena->Overflows = NULL;
+        arena->OverflowSize = 0;
+        arena->Frame = _frame;
+        _arena.Set(arena);
+        g_FrameArenaHeapAllocations.Increment();
+        return arena;
+    }
+
+    void FrameArena::Reset(Arena* arena)
+    {
+        // usage of the previous frame is reported by the next one
+        g_FrameArenaBytes.Add(long(arena->Top - arena->Base + arena->OverflowSize));
+
+        if (arena->Overflows)
+        {
+            // grow the main block to fit the whole last frame
+            size_t size = (arena->End - arena->Base) + arena->OverflowSize;
+            while (arena->Overflows)
+            {
+                Overflow* next = arena->Overflows->Next;
+                _aligned_free(arena->Overflows);
+                arena->Overflows = next;
+            }
+            _aligned_free(arena->Base);
+            arena->Base = (char*)_aligned_malloc(size, Alignment);
+            arena->End = arena->Base + size;
+            arena->OverflowSize = 0;
+            g_FrameArenaHeapAllocations.Increment();
+        }
+
+        arena->Top = arena->Base;
+        arena->Frame = _frame;
+    }
+
+    void* FrameArena::AllocateOverflow(Arena* arena, size_t size)
+    {
+        // header is padded to keep the alignment
+        size_t header = (sizeof(Overflow) + Alignment - 1) & ~size_t(Alignment - 1);
+        Overflow* overflow = (Overflow*)_aligned_malloc(header + size, Alignment);
+        overflow->Next = arena->Overflows;
+        arena->Overflows = overflow;
+        arena->OverflowSize += size;
+        g_FrameArenaHeapAllocations.Increment();
+        return (char*)overflow + header;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "ThreadLocal.h"
+#include "Atomic.h"
+#include "Metrics.h"
+
+namespace P3D
+{
+    /*
+    Per-thread linear allocator for data that lives till the end of the frame.
+    Allocation moves a pointer, memory is never freed individually.
+    Arena of a thread is reset by its first allocation after EndFrame,
+    so all memory taken from the arena is invalid after EndFrame.
+    When the block is full overflow blocks are taken from the heap, on reset they are
+    merged into one bigger block so steady-state frames don't touch the heap.
+    */
+    class FrameArena
+    {
+    public:
+        enum
+        {
+            InitialBlockSize = 64 * 1024,
+            Alignment = 16
+        };
+
+        /*
+        Allocate memory in the arena of the calling thread.
+        */
+        static void* Allocate(size_t size)
+        {
+            size = (size + Alignment - 1) & ~size_t(Alignment - 1);
+            Arena* arena = GetArena();
+            if (arena->Frame != _frame) Reset(arena);
+            if (size > size_t(arena->End - arena->Top)) return AllocateOverflow(arena, size);
+
+            void* result = arena->Top;
+            arena->Top += size;
+            return result;
+        }
+
+        /*
+        Memory is released on reset.
+        */
+        static void Deallocate(void*, size_t)
+        { }
+
+        /*
+        Finish the frame, memory allocated during the frame by all threads becomes invalid.
+        Call once per frame when no thread uses frame data.
+        */
+        static void EndFrame()
+        {
+            AtomicIncrement(&_frame);
+        }
+
+    private:
+        struct Overflow
+        {
+            Overflow* Next;
+        };
+
+        struct Arena
+        {
+            char* Base;
+            char* Top;
+            char* End;
+            Overflow* Overflows; // blocks allocated when the main block was full
+            size_t OverflowSize;
+            long Frame;
+        };
+
+        static inline Arena* GetArena()
+        {
+            Arena* arena = _arena.Get();
+            return arena ? arena : CreateArena();
+        }
+
+        static Arena* CreateArena();
+        static void Reset(Arena* arena);
+        static void* AllocateOverflow(Arena* arena, size_t size);
+
+        static ThreadLocal<Arena> _arena;
+        static volatile long _frame;
+    };
+
+    /*
+    STL allocator taking memory from the frame arena.
+    Containers with this allocator should not outlive the frame.
+    */
+    template<class T>
+    class FrameAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<class U>
+        struct rebind
+        {
+            typedef FrameAllocator<U> other;
+        };
+
+        FrameAllocator() { }
+        FrameAllocator(const FrameAllocator&) { }
+        template<class U> FrameAllocator(const FrameAllocator<U>&) { }
+
+        pointer address(reference value) const { return &value; }
+        const_pointer address(const_reference value) const { return &value; }
+
+        pointer allocate(size_type count, const void* = 0)
+        {
+            return (pointer)FrameArena::Allocate(count * sizeof(T));
+        }
+
+        void deallocate(pointer p, size_type count)
+        {
+            FrameArena::Deallocate(p, count * sizeof(T));
+        }
+
+        void construct(pointer p, const T& value) { new((void*)p) T(value); }
+        void destroy(pointer p) { p->~T(); }
+
+        size_type max_size() const { return size_t(-1) / sizeof(T); }
+
+        template<class U> bool operator==(const FrameAllocator<U>&) const { return true; }
+        template<class U> bool operator!=(const FrameAllocator<U>&) const { return false; }
+    };
+
+    /*
+    Frame containers. Usage: FrameVector<int>::Type list;
+    */
+    template<class T>
+    struct FrameVector
+    {
+        typedef std::vector<T, FrameAllocator<T> > Type;
+    };
+
+    typedef std::basic_string<char, std::char_traits<char>, FrameAllocator<char> > FrameString;
+    typedef std::basic_ostringstream<char, std::char_traits<char>, FrameAllocator<char> > FrameStringStream;
+}
\ No newline at end of file
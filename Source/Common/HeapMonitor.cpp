@@ -0,0 +1,74 @@
+#include "Includes.h"
+#include "HeapMonitor.h"
+#include "Config.h"
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+namespace P3D
+{
+    Logger HeapMonitor::logger(L"System.HeapMonitor");
+
+    bool HeapMonitor::_started = false;
+    uint HeapMonitor::_frame = 0;
+    uint HeapMonitor::_settleFrames = HeapMonitor::DefaultSettleFrames;
+    uint HeapMonitor::_warnings = 0;
+
+    static Counter g_HeapAllocations("Memory.HeapAllocations", "allocations");
+
+    // allocations since the last EndFrame, the hook can't use metrics since they may allocate
+    static volatile long g_FrameAllocations = 0;
+
+#ifdef _DEBUG
+    static _CRT_ALLOC_HOOK g_PreviousHook = NULL;
+
+    static int __cdecl CountAllocation(int allocType, void* userData, size_t size, int blockType,
+        long requestNumber, const unsigned char* fileName, int lineNumber)
+    {
+        // CRT blocks are internal allocations of the CRT itself
+        if (blockType != _CRT_BLOCK && (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC))
+            AtomicIncrement(&g_FrameAllocations);
+        if (g_PreviousHook)
+            return g_PreviousHook(allocType, userData, size, blockType, requestNumber, fileName, lineNumber);
+        return TRUE;
+    }
+#endif
+
+    void HeapMonitor::Start()
+    {
+        if (_started) return;
+        _started = true;
+        _settleFrames = Config::GetInstance().ReadInt("HeapMonitor", "settleFrames", DefaultSettleFrames);
+        _frame = 0;
+        _warnings = 0;
+        g_FrameAllocations = 0;
+#ifdef _DEBUG
+        g_PreviousHook = _CrtSetAllocHook(CountAllocation);
+#else
+        logger.info() << L"Heap allocations are counted in debug builds only";
+#endif
+    }
+
+    void HeapMonitor::Stop()
+    {
+        if (!_started) return;
+        _started = false;
+#ifdef _DEBUG
+        _CrtSetAllocHook(g_PreviousHook);
+        g_PreviousHook = NULL;
+#endif
+    }
+
+    void HeapMonitor::EndFrame()
+    {
+        if (!_started) return;
+        long allocations = AtomicExchange(&g_FrameAllocations, 0);
+        g_HeapAllocations.Add(allocations);
+
+        _frame++;
+        if (allocations == 0 || _frame <= _settleFrames || _warnings >= MaxWarnings) return;
+        _warnings++;
+        logger.warn() << L"Frame " << _frame << L" made " << int(allocations) << L" heap allocations"
+            << (_warnings == MaxWarnings ? L", further frames are not reported" : L"");
+    }
+}
\ No newline at end of file
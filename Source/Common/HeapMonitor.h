@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Metrics.h"
+#include "Logger.h"
+
+namespace P3D
+{
+    /*
+    Counts heap allocations of all threads and publishes them per frame
+    as Memory.HeapAllocations counter. Frames should not allocate once sizes
+    of per-frame data are settled, EndFrame warns when a settled frame allocates.
+    Allocations are seen through the CRT allocation hook which exists in debug CRT only,
+    in release builds the counter stays at zero.
+    */
+    class HeapMonitor
+    {
+    public:
+        enum
+        {
+            DefaultSettleFrames = 100,
+            MaxWarnings = 10 // warnings allocate too, don't flood the log
+        };
+
+        /*
+        Install the allocation hook.
+        'settleFrames' attribute of 'HeapMonitor' config section is count of first frames allowed to allocate.
+        */
+        static void Start();
+
+        /*
+        Remove the allocation hook.
+        */
+        static void Stop();
+
+        /*
+        Publish allocations of the finished frame. Call once per frame before Metrics::EndFrame.
+        */
+        static void EndFrame();
+
+    private:
+        static bool _started;
+        static uint _frame;
+        static uint _settleFrames;
+        static uint _warnings;
+
+        static Logger logger;
+    };
+}
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 
+#if defined(_WIN32)
 #define P3D_WINDOWS
+#else
+#define P3D_POSIX
+#endif
 
 #pragma region ("Disabling of these specific warnings")
 #pragma warning(disable:4290)             
@@ -48,10 +52,15 @@ namespace std
 
 #include "Common/DataTypes.h"
 
+#if defined(_MSC_VER)
 #define ALIGNED_VARIABLE(alignment, type, name) __declspec(align(alignment)) type name;
+#define forceinline __forceinline
+#else
+#define ALIGNED_VARIABLE(alignment, type, name) type name __attribute__((aligned(alignment)));
+#define forceinline inline __attribute__((always_inline))
+#endif
 
 #define override virtual
-#define forceinline __forceinline
 
 #ifdef MAX_PATH
 #undef MAX_PATH
@@ -168,6 +177,8 @@ inline void Destruct(T* ptr)
 
 #if defined(P3D_WINDOWS)
 #include "Common/Windows/Includes.h"
+#elif defined(P3D_POSIX)
+#include "Common/Posix/Includes.h"
 #endif
 
 // tinyxml
@@ -2,50 +2,73 @@
 
 namespace P3D
 {
-    template <class OwnerType, class T>
+    /*
+    Dirty flags of all lazy values of one owner, one bit per value.
+    Everything is dirty initially.
+    */
+    class DirtyFlags
+    {
+    public:
+        DirtyFlags() : _flags(~0u) { }
+
+        void Invalidate(uint mask) { _flags |= mask; }
+        void Clear(uint mask) { _flags &= ~mask; }
+        bool IsDirty(uint mask) const { return (_flags & mask) != 0; }
+
+    private:
+        uint _flags;
+    };
+
+    /*
+    Value recalculated on demand by the method of the owner.
+    Method and flag are template parameters, so only the value itself is stored,
+    dirty bit lives in DirtyFlags of the owner. Dependents are bits of values
+    calculated from this one, they are invalidated together with it by one write.
+    Method gets the previous value, so it can update it incrementally.
+    Usage:
+        typedef Lazy<Owner, T, &Owner::Recalculate, Dirty_Value, Dirty_Other> LazyValue;
+        LazyValue _value;
+        mutable DirtyFlags _dirty;
+        const T& GetValue() const { return _value.Get(this, _dirty); }
+    */
+    template <class OwnerType, class T, void (OwnerType::*Recalculate)(T&), uint Flag, uint Dependents = 0>
     class Lazy
     {
-        typedef void (OwnerType::*RecalculateMethod)(T&);
     public:
-        Lazy(OwnerType* owner, RecalculateMethod method) :
-          _owner(owner), _dirty(true), _method(method)
-        { }
+        enum { Mask = Flag | Dependents };
 
-        void Invalidate() { _dirty = true; }
-        bool IsDirty() const { return _dirty; }
+        /*
+        Invalidate the value and its dependents.
+        */
+        static void Invalidate(DirtyFlags& flags) { flags.Invalidate(Mask); }
 
-        T& operator()()
-        {
-            Update();
-            return _t;
-        }
+        static bool IsDirty(const DirtyFlags& flags) { return flags.IsDirty(Flag); }
 
-        const T& operator()() const
+        const T& Get(const OwnerType* owner, DirtyFlags& flags) const
         {
-            Update();
+            Update(owner, flags);
             return _t;
         }
 
-        void Update() const
+        void Update(const OwnerType* owner, DirtyFlags& flags) const
         {
-            if (_dirty)
+            if (flags.IsDirty(Flag))
             {
-                (const_cast<OwnerType*>(_owner)->*_method)(_t);
-                _dirty = false;
+                (const_cast<OwnerType*>(owner)->*Recalculate)(_t);
+                flags.Clear(Flag);
             }
         }
 
-        void Set(const T& t)
+        /*
+        Set the value, dependents are not touched.
+        */
+        void Set(const T& t, DirtyFlags& flags)
         {
             _t = t;
-            _dirty = false;
+            flags.Clear(Flag);
         }
 
     private:
-        OwnerType* _owner;
-        RecalculateMethod _method;
- 
-        mutable bool _dirty;
         mutable T _t;
     };
 }
\ No newline at end of file
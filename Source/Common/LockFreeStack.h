@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Atomic.h"
+
+namespace P3D
+{
+    template<class T> class LockFreeStack;
+
+    /*
+    Base class for items of LockFreeStack.
+    */
+    class LockFreeStackNode
+    {
+    public:
+        LockFreeStackNode() : _nextInStack(NULL)
+        { }
+
+    private:
+        template<class T> friend class LockFreeStack;
+
+        LockFreeStackNode* _nextInStack;
+    };
+
+    /*
+    Intrusive lock-free LIFO stack (Treiber stack).
+    Top pointer is paired with a counter changed on each pop so the stack is not
+    affected by ABA problem. Items should not be deleted while other threads may pop them.
+    Top and counter are swapped by single 64 bit CAS: with 32 bit pointers the counter
+    takes the upper half, with 64 bit ones it takes the upper 16 bits which are
+    not used by user space addresses (47 bits on x64).
+    T should be inherited from LockFreeStackNode.
+    */
+    template<class T>
+    class LockFreeStack
+    {
+    public:
+        LockFreeStack()
+        {
+            _head = 0;
+        }
+
+        /*
+        Put item on top of the stack.
+        */
+        void Push(T* item)
+        {
+            LockFreeStackNode* node = item;
+            ASSERT((uint64(size_t(node)) & ~PointerMask()) == 0);
+            int64 old, fresh;
+            do
+            {
+                old = _head;
+                node->_nextInStack = GetTop(old);
+                fresh = MakeHead(node, GetTag(old));
+            } while (AtomicCAS64(&_head, fresh, old) != old);
+        }
+
+        /*
+        Take item from the top. Return NULL if stack is empty.
+        */
+        T* Pop()
+        {
+            int64 old, fresh;
+            LockFreeStackNode* top;
+            do
+            {
+                old = _head;
+                top = GetTop(old);
+                if (top == NULL) return NULL;
+                fresh = MakeHead(top->_nextInStack, GetTag(old) + 1);
+            } while (AtomicCAS64(&_head, fresh, old) != old);
+            return static_cast<T*>(top);
+        }
+
+        /*
+        Return true if stack seems to be empty.
+        */
+        bool IsEmpty() const
+        {
+            return GetTop(_head) == NULL;
+        }
+
+    private:
+        // head is top pointer in the lower PointerBits and tag above them
+        enum { PointerBits = sizeof(void*) == 4 ? 32 : 48 };
+        STATIC_ASSERT(sizeof(void*) == 4 || sizeof(void*) == 8);
+        STATIC_ASSERT(sizeof(size_t) == sizeof(void*));
+
+        static inline uint64 PointerMask() { return (uint64(1) << PointerBits) - 1; }
+
+        static inline LockFreeStackNode* GetTop(int64 head)
+        {
+            return (LockFreeStackNode*)size_t(uint64(head) & PointerMask());
+        }
+
+        static inline uint64 GetTag(int64 head)
+        {
+            return uint64(head) >> PointerBits;
+        }
+
+        static inline int64 MakeHead(LockFreeStackNode* top, uint64 tag)
+        {
+            return int64((tag << PointerBits) | uint64(size_t(top)));
+        }
+
+        ALIGNED_VARIABLE(8, volatile int64, _head);
+    };
+}
\ No newline at end of file
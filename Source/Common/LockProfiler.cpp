@@ -0,0 +1,112 @@
+#include "Includes.h"
+#include "LockProfiler.h"
+#include "Config.h"
+
+namespace P3D
+{
+    Logger LockProfiler::logger(L"System.LockProfiler");
+
+    volatile bool LockProfiler::_enabled = false;
+    Lock LockProfiler::_lock;
+    std::map<std::string, LockProfiler::Stats*> LockProfiler::_stats;
+    String LockProfiler::_reportFile;
+
+    // applies edited config to the running profiler
+    class LockProfilerConfigListener : public ConfigListener
+    {
+    public:
+        override void OnConfigChanged() { LockProfiler::Configure(); }
+    };
+
+    static LockProfilerConfigListener g_ConfigListener;
+
+    void LockProfiler::Configure()
+    {
+        static bool listening = false;
+        Config& config = Config::GetInstance();
+        if (!listening)
+        {
+            listening = true;
+            config.AddListener(&g_ConfigListener);
+        }
+        _reportFile = config.ReadWideString("LockProfiler", "report");
+        SetEnabled(config.ReadBool("LockProfiler", "enabled", false));
+    }
+
+    LockProfiler::Stats* LockProfiler::GetStats(const char* name)
+    {
+        AutoLock lock(_lock);
+        Stats*& stats = _stats[name];
+        if (stats == NULL)
+        {
+            stats = new Stats();
+            stats->Name = name;
+            stats->Acquisitions = 0;
+            stats->Contentions = 0;
+            stats->WaitTicks = 0;
+            stats->MaxWaitTicks = 0;
+        }
+        return stats;
+    }
+
+    void LockProfiler::RecordContention(Stats* stats, uint64 waitTicks, const char* holderSite)
+    {
+        AutoLock lock(_lock);
+        stats->Contentions++;
+        stats->WaitTicks += waitTicks;
+        if (waitTicks > stats->MaxWaitTicks) stats->MaxWaitTicks = waitTicks;
+        stats->BlockingSites[holderSite ? holderSite : "unknown"] += waitTicks;
+    }
+
+    void LockProfiler::WriteReport()
+    {
+        if (!IsEnabled()) return;
+
+        FILE* file = NULL;
+        if (!_reportFile.empty())
+        {
+            file = _wfopen(_reportFile.c_str(), L"wt");
+            if (!file)
+                logger.error() << L"Can't create lock report " << _reportFile;
+        }
+
+        AutoLock lock(_lock);
+        std::vector<Stats*> sorted;
+        for (std::map<std::string, Stats*>::iterator it = _stats.begin(); it != _stats.end(); ++it)
+            sorted.push_back(it->second);
+        std::sort(sorted.begin(), sorted.end(), WaitGreater());
+
+        double msecsPerTick = 1000.0 / TimeCounter::GetTicksPerSecond();
+        if (file)
+            fprintf(file, "Lock,Acquisitions,Contentions,Wait (ms),Max wait (ms),Blocking site,Site wait (ms)\n");
+        for (uint i = 0; i < sorted.size(); i++)
+        {
+            const Stats* stats = sorted[i];
+            logger.info() << ToUTF16(stats->Name) << L": " << stats->Acquisitions << L" acquisitions, "
+                << stats->Contentions << L" contended, wait " << stats->WaitTicks * msecsPerTick
+                << L" ms, max " << stats->MaxWaitTicks * msecsPerTick << L" ms";
+
+            // sites where the lock was held while others waited
+            std::vector<std::pair<uint64, std::string> > sites;
+            for (std::map<std::string, uint64>::const_iterator site = stats->BlockingSites.begin();
+                site != stats->BlockingSites.end(); ++site)
+                sites.push_back(std::make_pair(site->second, site->first));
+            std::sort(sites.rbegin(), sites.rend());
+
+            for (uint j = 0; j < sites.size(); j++)
+            {
+                if (j < ReportedSites)
+                    logger.info() << L"    held at " << ToUTF16(sites[j].second) << L": "
+                        << sites[j].first * msecsPerTick << L" ms";
+                if (file)
+                    fprintf(file, "%s,%ld,%ld,%.3f,%.3f,%s,%.3f\n", stats->Name.c_str(), stats->Acquisitions,
+                        stats->Contentions, stats->WaitTicks * msecsPerTick, stats->MaxWaitTicks * msecsPerTick,
+                        sites[j].second.c_str(), sites[j].first * msecsPerTick);
+            }
+            if (file && sites.empty())
+                fprintf(file, "%s,%ld,%ld,0,0,,0\n", stats->Name.c_str(), stats->Acquisitions, stats->Contentions);
+        }
+
+        if (file) fclose(file);
+    }
+}
\ No newline at end of file
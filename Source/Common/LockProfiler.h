@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Synchronization.h"
+#include "Atomic.h"
+#include "TimeCounter.h"
+#include "Logger.h"
+
+namespace P3D
+{
+    /*
+    Collects contention statistics of named locks (see ProfiledLock).
+    Disabled by default, enable it in config to find serialization points.
+    */
+    class LockProfiler
+    {
+    public:
+        /*
+        Statistics of all locks with the same name.
+        */
+        struct Stats
+        {
+            std::string Name;
+            volatile long Acquisitions;
+            volatile long Contentions;
+            uint64 WaitTicks; // total time waited for the lock
+            uint64 MaxWaitTicks;
+            std::map<std::string, uint64> BlockingSites; // wait time per site of the holder
+        };
+
+        static void SetEnabled(bool enabled) { _enabled = enabled; }
+        static bool IsEnabled() { return _enabled; }
+
+        /*
+        Return statistics of the locks with given name. Returned object lives till exit.
+        */
+        static Stats* GetStats(const char* name);
+
+        /*
+        Account time waited for the lock held at holderSite.
+        */
+        static void RecordContention(Stats* stats, uint64 waitTicks, const char* holderSite);
+
+        /*
+        Write statistics sorted by total wait time to the log and to the report file if it is set.
+        */
+        static void WriteReport();
+
+        /*
+        Read settings from the config, they are read again when the config is reloaded.
+        */
+        static void Configure();
+
+    private:
+        enum { ReportedSites = 3 };
+
+        struct WaitGreater
+        {
+            bool operator()(const Stats* a, const Stats* b) const { return a->WaitTicks > b->WaitTicks; }
+        };
+
+        static Logger logger;
+
+        static volatile bool _enabled;
+        static Lock _lock;
+        static std::map<std::string, Stats*> _stats;
+        static String _reportFile;
+    };
+
+    /*
+    Lock with a name which reports contention to LockProfiler.
+    Acquisitions through auto_lock also remember the source location so
+    blocked threads know where the holder took the lock.
+    Without profiling costs one flag check per Enter.
+    */
+    template<class LockType>
+    class ProfiledLock : public LockType
+    {
+    public:
+        explicit ProfiledLock(const char* name)
+            : _name(name), _stats(NULL), _site(NULL)
+        { }
+
+        void Enter(const char* site = NULL)
+        {
+            if (!LockProfiler::IsEnabled())
+            {
+                LockType::Enter();
+                return;
+            }
+
+            if (!LockType::TryEnter())
+            {
+                // site of the holder is read without the lock, it is only a hint
+                const char* holder = _site;
+                uint64 start = TimeCounter::GetTickCount();
+                LockType::Enter();
+                LockProfiler::RecordContention(GetStats(), TimeCounter::GetTickCount() - start, holder);
+            }
+            AtomicIncrement(&GetStats()->Acquisitions);
+            _site = site;
+        }
+
+        const char* GetName() const { return _name; }
+
+    private:
+        LockProfiler::Stats* GetStats()
+        {
+            if (_stats == NULL)
+                _stats = LockProfiler::GetStats(_name);
+            return _stats;
+        }
+
+        const char* _name;
+        LockProfiler::Stats* _stats;
+        const char* volatile _site;
+    };
+
+    template<class LockType>
+    inline void EnterLock(ProfiledLock<LockType>& lock, const char* site)
+    {
+        lock.Enter(site);
+    }
+}
\ No newline at end of file
@@ -17,5 +17,10 @@ namespace P3D
         Called by Log to process new log message.
         */
         virtual void ProcessLogMessage(const LogMessage& msg) = 0;
+
+        /*
+        Write buffered messages. Called after each batch of messages.
+        */
+        virtual void Flush() {}
     };
 }
\ No newline at end of file
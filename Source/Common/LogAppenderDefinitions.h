@@ -5,6 +5,7 @@
 #include "DebugOutputAppender.h"
 #include "FileAppender.h"
 #include "ConsoleOutputAppender.h"
+#include "BinaryFileAppender.h"
 
 namespace P3D
 {
@@ -22,7 +23,8 @@ namespace P3D
 		{
 			{ "Debug", &DebugOutputAppender::CreateFromXMLDefenition },
 			{ "File", &FileAppender::CreateFromXMLDefenition },
-			{ "Console", &ConsoleOutputAppender::CreateFromXMLDefenition }
+			{ "Console", &ConsoleOutputAppender::CreateFromXMLDefenition },
+			{ "Binary", &BinaryFileAppender::CreateFromXMLDefenition }
 		};
 	}
 }
\ No newline at end of file
@@ -25,8 +25,9 @@ namespace P3D
         const wchar* Source;
         const wchar* Time;
         long ThreadID;
+        uint64 Timestamp; // TimeCounter ticks when the message was logged
 
-        LogMessage(const wchar* msg, LogLevel level, const wchar* source, const wchar* time);
+        LogMessage(const wchar* msg, LogLevel level, const wchar* source, const wchar* time, long threadID, uint64 timestamp);
 
         /*
         Formats message in default way:
@@ -6,7 +6,7 @@ namespace P3D
 {
     LogStream::~LogStream()
     {
-        if (!_buffer.empty()) 
+        if (_owner && !_buffer.empty()) 
         {
             if (_buffer[_buffer.size() - 1] != '.' && _buffer[_buffer.size() - 1] != '!') _buffer += '.';
             _owner->Message(_level, _buffer.c_str());
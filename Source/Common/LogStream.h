@@ -12,16 +12,17 @@ namespace P3D
     {
         friend class Logger;
     public:
-        inline LogStream& operator<<(const wchar* ch) { _buffer += ch; return *this; }
-        inline LogStream& operator<<(const String& ch) { _buffer += ch; return *this; }
-        inline LogStream& operator<<(const char* ch) { _buffer += String(ToUTF16(ch)); return *this; }
-        inline LogStream& operator<<(const std::string& ch) { _buffer += ToUTF16(ch); return *this; }
-        inline LogStream& operator<<(int i)  {  wchar buf[256]; _buffer += _itow(i, buf, 10); return *this; }
-        inline LogStream& operator<<(unsigned int i)  {  wchar buf[256]; _buffer += _itow(i, buf, 10); return *this; }
-        inline LogStream& operator<<(double i) { char buf[_CVTBUFSIZE]; *this << _gcvt(i, 4, buf); return *this; }
-        inline LogStream& operator<<(const Exception& exc) { *this << exc.GetFullDescription(); return *this; }
+        inline LogStream& operator<<(const wchar* ch) { if (_owner) _buffer += ch; return *this; }
+        inline LogStream& operator<<(const String& ch) { if (_owner) _buffer += ch; return *this; }
+        inline LogStream& operator<<(const char* ch) { if (_owner) _buffer += String(ToUTF16(ch)); return *this; }
+        inline LogStream& operator<<(const std::string& ch) { if (_owner) _buffer += ToUTF16(ch); return *this; }
+        inline LogStream& operator<<(int i)  { if (_owner) { wchar buf[256]; _buffer += _itow(i, buf, 10); } return *this; }
+        inline LogStream& operator<<(unsigned int i)  { if (_owner) { wchar buf[256]; _buffer += _itow(i, buf, 10); } return *this; }
+        inline LogStream& operator<<(double i) { if (_owner) { char buf[_CVTBUFSIZE]; *this << _gcvt(i, 4, buf); } return *this; }
+        inline LogStream& operator<<(const Exception& exc) { if (_owner) *this << exc.GetFullDescription(); return *this; }
         inline LogStream& operator<<(void* ptr)
         { 
+            if (!_owner) return *this;
             wchar buf1[32];
             _itow(reinterpret_cast<size_t>(ptr), buf1, 16);
             int len = wcslen(buf1);
@@ -46,7 +47,7 @@ namespace P3D
     private:
         LogStream(Logger* owner, LogLevel level) : _owner(owner), _level(level) { }
 
-        Logger* _owner;
+        Logger* _owner; // NULL if the message is disabled
         LogLevel _level;
         String _buffer;
     };
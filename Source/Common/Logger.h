@@ -7,15 +7,36 @@ namespace P3D
 {
     /*
     Auto append source to the log message.
+    Caches levels enabled for its source, disabled messages are not formatted.
     */
     class Logger
     {
     public:
-        inline Logger(const String& source) : Source(source) { }
+        inline Logger(const String& source) : Source(source), _state(InvalidState) { }
         inline ~Logger() { }
         inline void Message(LogLevel level, const wchar* msg) { LoggingSystem::GetInstance().Message(msg, level, Source); }
 
-        inline LogStream log(LogLevel level) { return LogStream(this, level); }
+        /*
+        Return true in case some appender accepts messages of the level from the logger.
+        */
+        inline bool IsEnabled(LogLevel level)
+        {
+            long state = _state;
+            if ((state >> LevelBits) != (LoggingSystem::GetGeneration() & GenerationMask))
+                state = UpdateLevels();
+            return (state & (1 << level)) != 0;
+        }
+
+        /*
+        Change source of the logger.
+        */
+        inline void SetSource(const String& source)
+        {
+            Source = source;
+            _state = InvalidState;
+        }
+
+        inline LogStream log(LogLevel level) { return LogStream(IsEnabled(level) ? this : NULL, level); }
         inline LogStream trace() { return log(LOG_TRACE); }
         inline LogStream debug() { return log(LOG_DEBUG); }
         inline LogStream info() { return log(LOG_INFO); }
@@ -24,5 +45,49 @@ namespace P3D
 
     public:
         String Source;
+
+    private:
+        enum
+        {
+            LevelBits = 8,
+            GenerationMask = 0x7FFFFF, // keeps packed state positive
+            InvalidState = -1 // never matches a generation
+        };
+
+        inline long UpdateLevels()
+        {
+            // take generation first: if appenders change meanwhile levels will be updated once more
+            long generation = LoggingSystem::GetGeneration() & GenerationMask;
+            long levels = LoggingSystem::GetInstance().GetEnabledLevels(Source);
+            long state = (generation << LevelBits) | levels;
+            _state = state;
+            return state;
+        }
+
+        /*
+        Enabled levels and generation of LoggingSystem they are valid for packed in one word,
+        so threads sharing the logger never see levels of one generation tagged with another.
+        Bit (1 << level) is set for enabled levels, generation is above LevelBits.
+        */
+        volatile long _state;
     };
-}
\ No newline at end of file
+}
+
+// Minimal level of messages compiled in, lower levels are stripped out.
+#ifndef P3D_LOG_LEVEL
+#   ifdef _DEBUG
+#       define P3D_LOG_LEVEL ::P3D::LOG_TRACE
+#   else
+#       define P3D_LOG_LEVEL ::P3D::LOG_INFO
+#   endif
+#endif
+
+// Log with skipping formatting of disabled messages. Usage:
+// log_info(logger) << L"Loaded " << count << L" items";
+// Arguments are not evaluated if the message is disabled.
+#define log_level(logger, level) if ((level) < P3D_LOG_LEVEL || !(logger).IsEnabled(level)) {} else (logger).log(level)
+#define log_trace(logger) log_level(logger, ::P3D::LOG_TRACE)
+#define log_debug(logger) log_level(logger, ::P3D::LOG_DEBUG)
+#define log_info(logger)  log_level(logger, ::P3D::LOG_INFO)
+#define log_warn(logger)  log_level(logger, ::P3D::LOG_WARN)
+#define log_error(logger) log_level(logger, ::P3D::LOG_ERROR)
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "LoggingSystem.h"
 #include "LogAppender.h"
 #include "Thread.h"
+#include "TimeCounter.h"
 
 #include "Exceptions.h"
 
@@ -13,13 +14,61 @@
 
 #include "LogAppenderDefinitions.h"
 
-#define LOG_BUFFER_SIZE 32768
 
 namespace P3D
 {
     DEFINE_SINGLETON(LoggingSystem);
 
+    volatile long LoggingSystem::_generation = 1;
+
+    /*
+    Background thread that passes queued messages to appenders.
+    */
+    class LoggingSystem::Writer :
+        public Thread
+    {
+    public:
+        Writer(LoggingSystem* system) : _system(system), _wakeEvent(Event::AutoReset)
+        { }
+
+        void WakeUp()
+        {
+            _wakeEvent.Signal();
+        }
+
+    protected:
+        enum { FlushPeriod = 100 }; // ms
+
+        override void MarkForTermination()
+        {
+            Thread::MarkForTermination();
+            _wakeEvent.Signal();
+        }
+
+        override void MessageLoop()
+        {
+            while (!_stoppingNow)
+            {
+                if (_system->ProcessQueue() > 0) continue;
+
+                // announce we are going to sleep and check the queue once more,
+                // producers wake us up only when we wait
+                AtomicExchange(&_system->_writerWaiting, 1);
+                if (_system->ProcessQueue() == 0 && !_stoppingNow)
+                    _wakeEvent.Wait(FlushPeriod);
+                AtomicExchange(&_system->_writerWaiting, 0);
+            }
+        }
+
+    private:
+        LoggingSystem* _system;
+        Event _wakeEvent;
+    };
+
     LoggingSystem::LoggingSystem()
+        : _queueMask(0), _enqueuePos(0), _dequeuePos(0), _flushedPos(0), 
+          _dropped(0), _droppedTotal(0), _writerWaiting(0), _producers(0), _flushedEvent(Event::AutoReset),
+          _writer(NULL), _async(false)
     {
         if (!LoadLoggerListenerDefs())
         {
@@ -37,6 +86,7 @@ namespace P3D
 
     LoggingSystem::~LoggingSystem()
     {
+        Stop();
         Message(L"-------------------", LOG_INFO, L"System.LoggingSystem");
 
         std::vector<LogAppender*> localCopy;
@@ -46,18 +96,202 @@ namespace P3D
             for (uint i = 0; i < _listeners.size(); i++)
                 localCopy.push_back(_listeners[i].Listener);
             _listeners.clear();
+            InvalidateFilters();
             // at that point we can safely release all listeners
         }
         for (uint i = 0; i < localCopy.size(); i++)
             localCopy[i]->Release();
+
+        if (_writer)
+            _writer->Release();
+    }
+
+    void LoggingSystem::Start()
+    {
+        if (_async || !Config::GetInstance().ReadBool("LoggingSystem", "async", true))
+            return;
+
+        if (_queue.empty())
+        {
+            // size should be power of two
+            uint size = 1;
+            uint requested = Config::GetInstance().ReadInt("LoggingSystem", "queueSize", DefaultQueueSize);
+            while (size < requested) size <<= 1;
+
+            _queue.resize(size);
+            for (uint i = 0; i < size; i++)
+                _queue[i].Sequence = i;
+            _queueMask = size - 1;
+        }
+
+        if (_writer == NULL)
+            _writer = new Writer(this);
+        _async = true;
+        _writer->Run("LogWriter");
+    }
+
+    void LoggingSystem::Stop()
+    {
+        if (!_async) return;
+
+        // new messages are written synchronously from now
+        _async = false;
+        ProcessorMemoryFence();
+
+        // producers that saw _async publish their messages, the writer is still there
+        // to free space for errors waiting in Post
+        while (_producers != 0)
+            Thread::YieldExecution();
+        _writer->Join();
+
+        // queued after the writer's last pass, all slots are published by now
+        ProcessQueue();
+    }
+
+    void LoggingSystem::Flush()
+    {
+        if (!_async || Thread::GetCurrentThread() == _writer)
+        {
+            AutoLock lock(_sync);
+            FlushAppenders();
+            return;
+        }
+
+        long target = _enqueuePos;
+        while (_flushedPos - target < 0 && _async)
+        {
+            _writer->WakeUp();
+            _flushedEvent.Wait(FlushWaitStep);
+        }
     }
 
     void LoggingSystem::Message(const String& msg, LogLevel level, const String& src)
     {
+        // writer logs synchronously, it shouldn't wait for itself
+        if (_async.Unfenced() && Thread::GetCurrentThread() != _writer)
+        {
+            // count ourselves before checking _async again, so Stop can wait for us
+            AtomicIncrement(&_producers);
+            if (_async.Unfenced())
+            {
+                Post(msg, level, src);
+                AtomicDecrement(&_producers);
+                if (level >= LOG_ERROR)
+                    Flush();
+                return;
+            }
+            AtomicDecrement(&_producers);
+        }
+
+        struct _timeb time;
+        _ftime64_s(&time);
+
+        AutoLock lock(_sync);
+        Dispatch(msg.c_str(), level, src.c_str(), Thread::GetCurrentThreadID(), time, TimeCounter::GetTickCount());
+        FlushAppenders();
+    }
+
+    void LoggingSystem::Post(const String& msg, LogLevel level, const String& src)
+    {
+        if (!Enqueue(msg, level, src))
+        {
+            if (level < LOG_ERROR)
+            {
+                AtomicIncrement(&_dropped);
+                AtomicIncrement(&_droppedTotal);
+                return;
+            }
+
+            // errors are never dropped, wait for the writer to free some space
+            do
+            {
+                _writer->WakeUp();
+                Thread::YieldExecution();
+            } while (!Enqueue(msg, level, src));
+        }
+
+        if (level < LOG_ERROR && AtomicCAS(&_writerWaiting, 0, 1) == 1)
+            _writer->WakeUp();
+    }
+
+    bool LoggingSystem::Enqueue(const String& msg, LogLevel level, const String& source)
+    {
+        long pos = _enqueuePos;
+        QueuedMessage* slot;
+        while (true)
+        {
+            slot = &_queue[pos & _queueMask];
+            long diff = slot->Sequence - pos;
+            if (diff == 0)
+            {
+                // slot is free, try to take it
+                long old = AtomicCAS(&_enqueuePos, pos + 1, pos);
+                if (old == pos) break;
+                pos = old;
+            } else if (diff < 0)
+                return false; // the writer hasn't processed the slot yet, buffer is full
+            else
+                pos = _enqueuePos;
+        }
+
+        slot->Level = level;
+        slot->ThreadID = Thread::GetCurrentThreadID();
+        _ftime64_s(&slot->Time);
+        slot->Timestamp = TimeCounter::GetTickCount();
+        slot->Message = msg;
+        slot->Source = source;
+        WriteMemoryBarrier();
+        slot->Sequence = pos + 1; // publish
+        return true;
+    }
+
+    uint LoggingSystem::ProcessQueue()
+    {
+        uint count = 0;
+        AutoLock lock(_sync);
+
+        while (true)
+        {
+            QueuedMessage& slot = _queue[_dequeuePos & _queueMask];
+            if (slot.Sequence != _dequeuePos + 1) break;
+            ReadMemoryBarrier();
+
+            Dispatch(slot.Message.c_str(), slot.Level, slot.Source.c_str(), slot.ThreadID, slot.Time, slot.Timestamp);
+            slot.Sequence = _dequeuePos + _queueMask + 1; // free for the next round
+            _dequeuePos++;
+            count++;
+        }
+
+        long dropped = AtomicExchange(&_dropped, 0);
+        if (dropped > 0)
+        {
+            struct _timeb time;
+            _ftime64_s(&time);
+            std::wostringstream os;
+            os << dropped << L" log messages were dropped, the queue is full.";
+            Dispatch(os.str().c_str(), LOG_WARN, L"System.LoggingSystem", Thread::GetCurrentThreadID(), time, TimeCounter::GetTickCount());
+        }
+
+        if (count > 0 || dropped > 0)
+        {
+            FlushAppenders();
+            _flushedPos = _dequeuePos;
+            _flushedEvent.Signal();
+        }
+        return count;
+    }
+
+    void LoggingSystem::Dispatch(const wchar* msg, LogLevel level, const wchar* src, long threadID, const struct _timeb& tstruct, uint64 timestamp)
+    {
+        // don't format message nobody wants
+        const std::vector<char>& accepting = GetAcceptingListeners(src);
+        bool wanted = false;
+        for (uint i = 0; i < _listeners.size() && !wanted; i++)
+            wanted = _listeners[i].Listener && accepting[i] && _listeners[i].Threshold <= level;
+        if (!wanted) return;
+
         // get local time
-        struct _timeb tstruct; 
         struct tm ttt;
-        _ftime64_s( &tstruct );
         localtime_s(&ttt, &tstruct.time);
 
         // format it as string
@@ -65,37 +299,74 @@ namespace P3D
         swprintf_s(time, L"%02i:%02i:%02i-%03i", 
                 ttt.tm_hour, ttt.tm_min, ttt.tm_sec, tstruct.millitm);
 
+        LogMessage message(msg, level, src, time, threadID, timestamp);
+
+        // pass message to suitable log listener.
+        for (uint i = 0; i < _listeners.size(); i++)
+        {
+            if (_listeners[i].Listener && accepting[i] && _listeners[i].Threshold <= level)
+                _listeners[i].Listener->ProcessLogMessage(message);
+        }
+    }
+
+    const std::vector<char>& LoggingSystem::GetAcceptingListeners(const wchar* src)
+    {
+        SourceCache::iterator it = _sourceCache.find(src);
+        if (it != _sourceCache.end())
+            return it->second;
+
         String nameSpace;
         String object;
-        uint lastDot = src.rfind('.');
-        if (lastDot == -1)
+        const wchar* lastDot = wcsrchr(src, '.');
+        if (lastDot == NULL)
         {
             nameSpace = L"";
             object = src;
         } else
         {
-            nameSpace = src.substr(0, lastDot);
-            object = src.substr(lastDot + 1, src.size() - lastDot - 1);
+            nameSpace.assign(src, lastDot);
+            object = lastDot + 1;
         }
 
-        {
-            AutoLock lock(_sync);
-            LogMessage message(msg.c_str(), level, src.c_str(), time);
+        std::vector<char>& accepting = _sourceCache[src];
+        accepting.resize(_listeners.size());
+        for (uint i = 0; i < _listeners.size(); i++)
+            accepting[i] = Accepts(_listeners[i], nameSpace, object);
+        return accepting;
+    }
 
-            // pass message to suitable log listener.
-            for (uint i = 0; i < _listeners.size(); i++)
-            {
-                if (_listeners[i].Listener && ShouldLog(_listeners[i], message, nameSpace, object))
-                    _listeners[i].Listener->ProcessLogMessage(message);
-            }
+    int LoggingSystem::GetEnabledLevels(const String& source)
+    {
+        AutoLock lock(_sync);
+
+        int levels = 0;
+        const std::vector<char>& accepting = GetAcceptingListeners(source.c_str());
+        for (uint i = 0; i < _listeners.size(); i++)
+        {
+            if (!_listeners[i].Listener || !accepting[i]) continue;
+            for (int level = _listeners[i].Threshold; level <= LOG_ERROR; level++)
+                levels |= 1 << level;
         }
+        return levels;
     }
 
-    bool LoggingSystem::ShouldLog(const LoggerListenerEntry& listener, const LogMessage& message, const String& nameSpace, const String& object)
+    void LoggingSystem::InvalidateFilters()
     {
-        if (listener.Threshold > message.Level)
-            return false;
+        _sourceCache.clear();
+        AtomicIncrement(&_generation);
+    }
 
+    void LoggingSystem::FlushAppenders()
+    {
+        for (uint i = 0; i < _listeners.size(); i++)
+        {
+            if (_listeners[i].Listener)
+                _listeners[i].Listener->Flush();
+        }
+    }
+
+    bool LoggingSystem::Accepts(const LoggerListenerEntry& listener, const String& nameSpace, const String& object)
+    {
         bool accepted = false;
         for (uint i = 0; i < listener.Accept.size(); ++i)
         {
@@ -127,6 +398,7 @@ namespace P3D
 
         listener->AddRef();
         _listeners.push_back(LoggerListenerEntry(listener, threshold, sources));
+        InvalidateFilters();
     }
 
     void LoggingSystem::RemoveAppender(LogAppender* listener)
@@ -150,6 +422,7 @@ namespace P3D
             }
             if (!foundOne) break;
         }
+        InvalidateFilters();
     }
 
     bool LoggingSystem::LoadLoggerListenerDefs()
@@ -235,13 +508,11 @@ namespace P3D
         return true;
     }
 
-    LogMessage::LogMessage(const wchar* msg, LogLevel level, const wchar* source, const wchar* time)
-        : Message(msg), Level(level), Source(source), Time(time)
+    LogMessage::LogMessage(const wchar* msg, LogLevel level, const wchar* source, const wchar* time, long threadID, uint64 timestamp)
+        : Message(msg), Level(level), Source(source), Time(time), ThreadID(threadID), Timestamp(timestamp)
     {
         std::wostringstream os;
 
-        ThreadID = Thread::GetCurrentThreadID();
-
         const wchar* levelS = L"";
         switch (Level)
         {
@@ -5,12 +5,21 @@
 #include "Singleton.h"
 #include "UtilFunctions.h"
 
+#include <sys/types.h>
+#include <sys/timeb.h>
+
 namespace P3D
 {
+    class Thread;
+
     /*
     Log singelton class. Provides login support.
     Can be extended by LogAppenders. The default appender is FileAppender to log.txt.
     Each log message has level and source information.
+    After Start messages are put into lock-free ring buffer and written by
+    the background writer thread, so logging thread never waits for the disk.
+    When the buffer is full messages are dropped (and counted), except errors.
+    Errors are flushed to appenders before Message returns.
     */
     class LoggingSystem :
         public Singleton<LoggingSystem>
@@ -36,10 +45,98 @@ namespace P3D
         */
         void RemoveAppender(LogAppender* appender);
 
+        /*
+        Return mask of levels (bit 1 << level) at least one appender accepts from the source.
+        */
+        int GetEnabledLevels(const String& source);
+
+        /*
+        Changed each time appenders are added or removed.
+        Loggers compare it with the value they cached enabled levels for.
+        */
+        static long GetGeneration() { return _generation; }
+
+        /*
+        Start background writer thread.
+        Controlled by 'async' and 'queueSize' attributes of 'LoggingSystem' config section.
+        */
+        void Start();
+
+        /*
+        Write queued messages and stop the writer. Messages are written synchronously after that.
+        */
+        void Stop();
+
+        /*
+        Wait till all queued messages are passed to appenders and appenders are flushed.
+        */
+        void Flush();
+
+        /*
+        Return count of messages dropped because the buffer was full.
+        */
+        long GetDroppedCount() const { return _droppedTotal; }
+
     private:
+        class Writer;
+        friend class Writer;
+
+        enum
+        {
+            DefaultQueueSize = 4096,
+            FlushWaitStep = 10 // ms
+        };
+
+        struct QueuedMessage
+        {
+            volatile long Sequence; // position in the queue the slot is ready for
+            LogLevel Level;
+            long ThreadID;
+            struct _timeb Time;
+            uint64 Timestamp;
+            String Message; // strings keep capacity, so slots are reused without allocations
+            String Source;
+        };
+
+        /*
+        Put message into ring buffer. Return false if buffer is full.
+        */
+        bool Enqueue(const String& msg, LogLevel level, const String& source);
+
+        /*
+        Enqueue message for the writer. Drops it if the buffer is full, errors wait for space instead.
+        */
+        void Post(const String& msg, LogLevel level, const String& source);
+
+        /*
+        Pass queued messages to appenders. Called by the writer only.
+        Return count of processed messages.
+        */
+        uint ProcessQueue();
+
+        /*
+        Format message and pass it to suitable appenders. _sync should be locked.
+        */
+        void Dispatch(const wchar* msg, LogLevel level, const wchar* source, long threadID, const struct _timeb& time, uint64 timestamp);
+
+        void FlushAppenders();
+
         // guards _listeners
         Lock _sync;
 
+        std::vector<QueuedMessage> _queue;
+        long _queueMask;
+        volatile long _enqueuePos;
+        volatile long _dequeuePos;
+        volatile long _flushedPos; // messages before it are flushed by appenders
+        volatile long _dropped; // dropped since last report
+        volatile long _droppedTotal;
+        volatile long _writerWaiting;
+        volatile long _producers; // threads putting messages into the queue, Stop waits for them
+        Event _flushedEvent;
+        Writer* _writer;
+        Fenced<bool> _async;
+
         struct LoggerSource
         {
             String Namespace;
@@ -104,7 +201,26 @@ namespace P3D
         */
         bool LoadLoggerListenerDefs();
 
-        bool ShouldLog(const LoggerListenerEntry& listener, const LogMessage& message, const String& nameSpace, const String& object);
+        /*
+        Return true in case listener accepts messages from the source.
+        */
+        bool Accepts(const LoggerListenerEntry& listener, const String& nameSpace, const String& object);
+
+        /*
+        Return flags of listeners (by index) accepting messages from the source. _sync should be locked.
+        */
+        const std::vector<char>& GetAcceptingListeners(const wchar* source);
+
+        /*
+        Appenders changed: drop cached source matching and invalidate loggers.
+        */
+        void InvalidateFilters();
+
+        // listeners accepting the source, cleared when listeners change
+        typedef std::map<String, std::vector<char> > SourceCache;
+        SourceCache _sourceCache;
+
+        static volatile long _generation;
     };
 
     void Log (LogLevel level, const String& source, const String& message);
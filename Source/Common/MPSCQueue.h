@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Object.h"
+#include "Atomic.h"
+#include "Synchronization.h"
+#include "TemplateTricks.h"
+
+namespace P3D
+{
+    template<class T> class MPSCQueue;
+
+    /*
+    Base class for objects that can be put into MPSCQueue.
+    Object can be in one queue at a time.
+    */
+    class MPSCQueueNode
+    {
+        template<class T> friend class MPSCQueue;
+    protected:
+        MPSCQueueNode() : _nextInQueue(NULL) {}
+
+    private:
+        MPSCQueueNode* volatile _nextInQueue;
+    };
+
+    /*
+    Lock-free unbounded queue of pointers to T with many producers and single consumer.
+    Nodes are intrusive (T should be derived from MPSCQueueNode) so putting
+    an object into the queue does not allocate memory.
+    Consumer blocks on event only when queue is empty, producers signal it
+    only when the consumer sleeps.
+    */
+    template<class T>
+    class MPSCQueue
+    {
+    public:
+        MPSCQueue() : _notEmpty(Event::AutoReset), _waiting(0)
+        {
+            _head = &_stub;
+            _tail = &_stub;
+        }
+
+        ~MPSCQueue()
+        {
+            Clear();
+        }
+
+        // Producer thread methods
+
+        /*
+        Adds message to the queue.
+        The method does not AddRefs it but take ownership.
+        */
+        void Put(T* msg)
+        {
+            Push(msg);
+
+            // wake up consumer if it sleeps
+            if (AtomicCAS(&_waiting, 0, 1) == 1)
+                _notEmpty.Signal();
+        }
+
+        /*
+        Wake up consumer waiting in Wait even if the queue is empty.
+        */
+        void Wake()
+        {
+            _notEmpty.Signal();
+        }
+
+        // Consumer thread methods
+
+        /*
+        Return next message in the queue or NULL if the queue is empty.
+        Can return NULL while some producer is in the middle of Put,
+        in this case the producer will wake consumer up.
+        */
+        T* Peek()
+        {
+            MPSCQueueNode* tail = _tail;
+            MPSCQueueNode* next = tail->_nextInQueue;
+            if (tail == &_stub)
+            {
+                if (next == NULL) return NULL;
+                _tail = next;
+                tail = next;
+                next = next->_nextInQueue;
+            }
+            if (next != NULL)
+            {
+                _tail = next;
+                return static_cast<T*>(tail);
+            }
+
+            if (tail != _head)
+                return NULL; // producer is in progress
+
+            // tail is the last node, put stub after it to be able to take it
+            Push(&_stub);
+            next = tail->_nextInQueue;
+            if (next != NULL)
+            {
+                _tail = next;
+                return static_cast<T*>(tail);
+            }
+            return NULL;
+        }
+
+        /*
+        Block till queue gets a message, Wake is called or timeout expires.
+        Return false on timeout.
+        */
+        bool Wait(uint timeout = INFINITE)
+        {
+            AtomicExchange(&_waiting, 1);
+            if (!IsEmpty())
+            {
+                _waiting = 0;
+                return true;
+            }
+            bool res = _notEmpty.Wait(timeout) == Event::Signaled;
+            _waiting = 0;
+            return res;
+        }
+
+        /*
+        Wait for message and return it. Return NULL in case of timeout.
+        */
+        T* Get(uint timeout = INFINITE)
+        {
+            while (true)
+            {
+                T* msg = Peek();
+                if (msg) return msg;
+                if (!Wait(timeout)) return NULL;
+            }
+        }
+
+        /*
+        Return true in case there is nothing to take.
+        Message that is being put right now is not counted.
+        */
+        bool IsEmpty() const
+        {
+            return _tail == &_stub && _stub._nextInQueue == NULL;
+        }
+
+        /*
+        Release all messages left in the queue.
+        */
+        void Clear()
+        {
+            while (T* msg = Peek())
+                ReleaseIfNeeded(msg);
+        }
+
+    private:
+        void Push(MPSCQueueNode* node)
+        {
+            node->_nextInQueue = NULL;
+            MPSCQueueNode* prev = (MPSCQueueNode*)AtomicExchangePointer((void* volatile*)&_head, node);
+            prev->_nextInQueue = node;
+        }
+
+        MPSCQueueNode* volatile _head; // producers push here
+        MPSCQueueNode* _tail; // consumer takes from here
+        MPSCQueueNode _stub;
+
+        Event _notEmpty;
+        volatile long _waiting; // 1 when consumer is going to sleep
+    };
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "Common/Config.h"
 #include "Common/Logger.h"
+#include "Common/LockProfiler.h"
+#include "Common/ThreadPool.h"
 
 using namespace P3D;
 
@@ -12,7 +14,8 @@ int SDL_main(int argc, char** argv)
     // initialize system-wide services
     AtExitManager atExitManager;
     Config::GetInstance();
-    LoggingSystem::GetInstance();
+    LoggingSystem::GetInstance().Start();
+    LockProfiler::Configure();
 
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0)
     {
@@ -21,6 +24,14 @@ int SDL_main(int argc, char** argv)
         return -1;
     }
 
+    // watcher uses SDL timer
+    Config::GetInstance().StartWatching();
+
+    // start default thread pool
+    ThreadPool* threadPool = new ThreadPool();
+    threadPool->Start();
+    ThreadPool::SetDefault(threadPool);
+
     int res = -1;
     try
     {
@@ -42,7 +53,19 @@ int SDL_main(int argc, char** argv)
         logger.error() << L"Unknown unhandled exception in the main thread.";
     }
 
+    Config::GetInstance().StopWatching();
+
+    ThreadPool::SetDefault(NULL);
+    threadPool->Stop();
+    threadPool->Release();
+
     SDL_Quit();
 
+    LockProfiler::WriteReport();
+    RefCountedBase::ReportLiveObjects();
+
+    // write all queued messages before at exit callbacks
+    LoggingSystem::GetInstance().Stop();
+
     return res;
 }
\ No newline at end of file
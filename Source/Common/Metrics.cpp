@@ -0,0 +1,225 @@
+#include "Includes.h"
+#include "Metrics.h"
+#include "Config.h"
+
+namespace P3D
+{
+    Logger Metrics::logger(L"System.Metrics");
+
+    Metric* volatile Metrics::_metrics = NULL;
+    volatile long Metrics::_usedSlots = 0;
+    Metrics::Shard* volatile Metrics::_shards = NULL;
+
+    ThreadLocal<Metrics::Shard> Metrics::_shard;
+
+    FILE* Metrics::_export = NULL;
+    uint Metrics::_exportFrame = 0;
+    std::vector<const Metric*> Metrics::_exportColumns;
+
+    Metric::Metric(const char* name, const char* unit, Kind kind, uint slots)
+        : _name(name), _unit(unit), _kind(kind), _slotCount(slots), _next(NULL)
+    {
+        Metrics::Register(this);
+    }
+
+    long Histogram::GetFramePercentile(float fraction) const
+    {
+        if (_frameCount == 0) return 0;
+        int64 limit = int64(_frameCount * fraction);
+        int64 count = 0;
+        for (uint i = 0; i < Buckets; i++)
+        {
+            count += _frameBuckets[i];
+            if (count > limit || count == _frameCount)
+                return i == 0 ? 0 : long((1u << i) - 1);
+        }
+        return LONG_MAX;
+    }
+
+    void Metrics::Register(Metric* metric)
+    {
+        // reserve slots, metrics above the limit share overflow slots at the end of shard
+        long first, used;
+        do
+        {
+            first = _usedSlots;
+            used = first + metric->_slotCount;
+            if (used > MaxSlots)
+            {
+                first = MaxSlots;
+                break;
+            }
+        } while (AtomicCAS(&_usedSlots, used, first) != first);
+        ASSERT(first < MaxSlots || metric->_slotCount == 0);
+        metric->_slot = first;
+
+        do
+        {
+            metric->_next = _metrics;
+        } while (AtomicCASPointer((void* volatile*)&_metrics, metric, metric->_next) != metric->_next);
+    }
+
+    Metrics::Shard* Metrics::CreateShard()
+    {
+        // shards are never deleted, values of finished threads stay in totals
+        Shard* shard = new Shard();
+        memset((void*)shard->Values, 0, sizeof(shard->Values));
+        memset(shard->Collected, 0, sizeof(shard->Collected));
+        do
+        {
+            shard->Next = _shards;
+        } while (AtomicCASPointer((void* volatile*)&_shards, shard, shard->Next) != shard->Next);
+        _shard.Set(shard);
+        return shard;
+    }
+
+    void Metrics::EndFrame()
+    {
+        for (Metric* metric = _metrics; metric; metric = metric->_next)
+        {
+            if (metric->_slot >= MaxSlots) continue;
+
+            // sum what was added to each shard since the last frame,
+            // values are only increased by owners so differences survive overflow of long
+            int64 sums[Histogram::Slots] = { 0 };
+            for (Shard* shard = _shards; shard; shard = shard->Next)
+            {
+                for (uint i = 0; i < metric->_slotCount; i++)
+                {
+                    uint slot = metric->_slot + i;
+                    long value = shard->Values[slot];
+                    sums[i] += long(ulong(value) - ulong(shard->Collected[slot]));
+                    shard->Collected[slot] = value;
+                }
+            }
+
+            if (metric->_kind == Metric::Kind_Counter)
+            {
+                Counter* counter = static_cast<Counter*>(metric);
+                counter->_frameValue = sums[0];
+                counter->_total += sums[0];
+            } else if (metric->_kind == Metric::Kind_Histogram)
+            {
+                Histogram* histogram = static_cast<Histogram*>(metric);
+                histogram->_frameCount = sums[0];
+                histogram->_frameSum = sums[1];
+                for (uint i = 0; i < Histogram::Buckets; i++)
+                    histogram->_frameBuckets[i] = sums[2 + i];
+                histogram->_total += sums[0];
+            }
+        }
+
+        if (_export) WriteExportFrame();
+    }
+
+    void Metrics::MakeSample(const Metric* metric, Sample& sample)
+    {
+        memset(&sample, 0, sizeof(sample));
+        sample.Name = metric->GetName();
+        sample.Unit = metric->GetUnit();
+        sample.Kind = metric->GetKind();
+        switch (metric->GetKind())
+        {
+            case Metric::Kind_Counter:
+            {
+                const Counter* counter = static_cast<const Counter*>(metric);
+                sample.Value = counter->GetFrameValue();
+                sample.Total = counter->GetTotal();
+                break;
+            }
+            case Metric::Kind_Gauge:
+                sample.Value = static_cast<const Gauge*>(metric)->Get();
+                break;
+            case Metric::Kind_Histogram:
+            {
+                const Histogram* histogram = static_cast<const Histogram*>(metric);
+                sample.Value = histogram->GetFrameCount();
+                sample.Total = histogram->GetTotal();
+                sample.Mean = histogram->GetFrameMean();
+                sample.P50 = histogram->GetFramePercentile(0.5f);
+                sample.P95 = histogram->GetFramePercentile(0.95f);
+                break;
+            }
+        }
+    }
+
+    void Metrics::GetSnapshot(std::vector<Sample>& samples)
+    {
+        samples.clear();
+        for (Metric* metric = _metrics; metric; metric = metric->_next)
+        {
+            Sample sample;
+            MakeSample(metric, sample);
+            samples.push_back(sample);
+        }
+    }
+
+    bool Metrics::GetSample(const char* name, Sample& sample)
+    {
+        for (Metric* metric = _metrics; metric; metric = metric->_next)
+        {
+            if (strcmp(metric->GetName(), name) == 0)
+            {
+                MakeSample(metric, sample);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Metrics::StartExport(const String& file)
+    {
+        StopExport();
+        _export = _wfopen(file.c_str(), L"wt");
+        if (!_export)
+        {
+            logger.error() << L"Can't create metrics file " << file;
+            return;
+        }
+
+        // columns are fixed by the header, metrics registered later are not exported
+        _exportColumns.clear();
+        _exportFrame = 0;
+        fprintf(_export, "Frame");
+        for (Metric* metric = _metrics; metric; metric = metric->_next)
+        {
+            _exportColumns.push_back(metric);
+            if (metric->GetKind() == Metric::Kind_Histogram)
+                fprintf(_export, ",%s.count,%s.mean (%s),%s.p95 (%s)", metric->GetName(),
+                    metric->GetName(), metric->GetUnit(), metric->GetName(), metric->GetUnit());
+            else
+                fprintf(_export, ",%s (%s)", metric->GetName(), metric->GetUnit());
+        }
+        fprintf(_export, "\n");
+    }
+
+    void Metrics::StopExport()
+    {
+        if (_export)
+        {
+            fclose(_export);
+            _export = NULL;
+        }
+    }
+
+    void Metrics::WriteExportFrame()
+    {
+        fprintf(_export, "%u", _exportFrame++);
+        for (uint i = 0; i < _exportColumns.size(); i++)
+        {
+            Sample sample;
+            MakeSample(_exportColumns[i], sample);
+            if (sample.Kind == Metric::Kind_Histogram)
+                fprintf(_export, ",%I64d,%.3f,%ld", sample.Value, sample.Mean, sample.P95);
+            else
+                fprintf(_export, ",%I64d", sample.Value);
+        }
+        fprintf(_export, "\n");
+    }
+
+    void Metrics::Configure()
+    {
+        String file = Config::GetInstance().ReadWideString("Metrics", "export");
+        if (!file.empty()) StartExport(file);
+    }
+}
\ No newline at end of file
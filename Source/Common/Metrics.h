@@ -0,0 +1,259 @@
+#pragma once
+
+#include "ThreadLocal.h"
+#include "Atomic.h"
+#include "Logger.h"
+
+namespace P3D
+{
+    class Metrics;
+
+    /*
+    Named performance metric. Metrics are usually global objects defined in
+    the module which updates them. Registration is lock-free and doesn't depend
+    on order of static initialization, so metrics can be defined in any module.
+    */
+    class Metric
+    {
+    public:
+        enum Kind
+        {
+            Kind_Counter,
+            Kind_Gauge,
+            Kind_Histogram
+        };
+
+        const char* GetName() const { return _name; }
+        const char* GetUnit() const { return _unit; }
+        Kind GetKind() const { return _kind; }
+
+    protected:
+        Metric(const char* name, const char* unit, Kind kind, uint slots);
+
+        /*
+        Return values of the current thread for this metric.
+        */
+        inline volatile long* GetSlots() const;
+
+    private:
+        friend class Metrics;
+
+        const char* _name;
+        const char* _unit;
+        Kind _kind;
+        uint _slot; // first slot in thread shards
+        uint _slotCount;
+        Metric* _next;
+    };
+
+    /*
+    Value summed over all threads, reported per frame.
+    Each thread adds to its own shard, shards are summed by Metrics::EndFrame.
+    */
+    class Counter : public Metric
+    {
+    public:
+        Counter(const char* name, const char* unit)
+            : Metric(name, unit, Kind_Counter, 1), _frameValue(0), _total(0)
+        { }
+
+        void Add(long value) { GetSlots()[0] += value; }
+        void Increment() { GetSlots()[0]++; }
+
+        /*
+        Return sum of values added during the last frame.
+        */
+        int64 GetFrameValue() const { return _frameValue; }
+
+        /*
+        Return sum of values added since the start.
+        */
+        int64 GetTotal() const { return _total; }
+
+    private:
+        friend class Metrics;
+
+        int64 _frameValue;
+        int64 _total;
+    };
+
+    /*
+    Last set value. Gauge is not sharded, it is set by one owner at a time.
+    */
+    class Gauge : public Metric
+    {
+    public:
+        Gauge(const char* name, const char* unit)
+            : Metric(name, unit, Kind_Gauge, 0), _value(0)
+        { }
+
+        void Set(long value) { _value = value; }
+        long Get() const { return _value; }
+
+    private:
+        volatile long _value;
+    };
+
+    /*
+    Distribution of recorded values with power of two buckets.
+    Bucket 0 counts values less than 1, bucket i counts values in [2^(i-1), 2^i).
+    */
+    class Histogram : public Metric
+    {
+    public:
+        enum
+        {
+            Buckets = 32,
+            Slots = Buckets + 2 // count, sum, buckets
+        };
+
+        Histogram(const char* name, const char* unit)
+            : Metric(name, unit, Kind_Histogram, Slots), _frameCount(0), _frameSum(0), _total(0)
+        {
+            memset(_frameBuckets, 0, sizeof(_frameBuckets));
+        }
+
+        void Record(long value)
+        {
+            volatile long* slots = GetSlots();
+            slots[0]++;
+            slots[1] += value;
+            slots[2 + GetBucket(value)]++;
+        }
+
+        /*
+        Return count of values recorded during the last frame.
+        */
+        int64 GetFrameCount() const { return _frameCount; }
+
+        /*
+        Return mean of values recorded during the last frame.
+        */
+        double GetFrameMean() const { return _frameCount ? double(_frameSum) / _frameCount : 0; }
+
+        /*
+        Return upper bound of the bucket containing given fraction (0..1) of values of the last frame.
+        */
+        long GetFramePercentile(float fraction) const;
+
+        /*
+        Return count of values recorded since the start.
+        */
+        int64 GetTotal() const { return _total; }
+
+        static uint GetBucket(long value)
+        {
+            if (value < 1) return 0;
+            uint bucket = 1;
+            if (value >= 1 << 16) { value >>= 16; bucket += 16; }
+            if (value >= 1 << 8) { value >>= 8; bucket += 8; }
+            if (value >= 1 << 4) { value >>= 4; bucket += 4; }
+            if (value >= 1 << 2) { value >>= 2; bucket += 2; }
+            if (value >= 1 << 1) { bucket += 1; }
+            // 64 bit long can go beyond the last bucket
+            return bucket < Buckets ? bucket : Buckets - 1;
+        }
+
+    private:
+        friend class Metrics;
+
+        int64 _frameCount;
+        int64 _frameSum;
+        int64 _frameBuckets[Buckets];
+        int64 _total;
+    };
+
+    /*
+    Registry of metrics.
+    Shards of all threads are aggregated by EndFrame which should be called by one
+    thread once per frame. Frame values of metrics are valid till the next EndFrame.
+    */
+    class Metrics
+    {
+    public:
+        enum
+        {
+            MaxSlots = 512 // values per thread shard
+        };
+
+        /*
+        State of the metric after the last frame.
+        */
+        struct Sample
+        {
+            const char* Name;
+            const char* Unit;
+            Metric::Kind Kind;
+            int64 Value; // counter: frame sum, gauge: value, histogram: frame count
+            int64 Total; // counter: sum since start, histogram: count since start
+            double Mean; // histogram only
+            long P50; // histogram only
+            long P95; // histogram only
+        };
+
+        /*
+        Sum thread shards into frame values and write the frame to the export file.
+        */
+        static void EndFrame();
+
+        /*
+        Return samples of all registered metrics.
+        */
+        static void GetSnapshot(std::vector<Sample>& samples);
+
+        /*
+        Return sample of the metric with given name. Return false if there is no such metric.
+        */
+        static bool GetSample(const char* name, Sample& sample);
+
+        /*
+        Start writing samples of each frame to CSV file.
+        */
+        static void StartExport(const String& file);
+        static void StopExport();
+
+        /*
+        Read settings from the config.
+        */
+        static void Configure();
+
+    private:
+        friend class Metric;
+
+        struct Shard
+        {
+            volatile long Values[MaxSlots + Histogram::Slots]; // written by the owner thread only, tail is for overflow
+            long Collected[MaxSlots + Histogram::Slots]; // values seen by the last EndFrame
+            Shard* Next;
+        };
+
+        static void Register(Metric* metric);
+        static Shard* CreateShard();
+        static void MakeSample(const Metric* metric, Sample& sample);
+        static void WriteExportFrame();
+
+        static inline Shard* GetShard()
+        {
+            Shard* shard = _shard.Get();
+            return shard ? shard : CreateShard();
+        }
+
+        static Logger logger;
+
+        // zero initialized before constructors of static metrics run
+        static Metric* volatile _metrics;
+        static volatile long _usedSlots;
+        static Shard* volatile _shards;
+
+        static ThreadLocal<Shard> _shard;
+
+        static FILE* _export;
+        static uint _exportFrame;
+        static std::vector<const Metric*> _exportColumns;
+    };
+
+    inline volatile long* Metric::GetSlots() const
+    {
+        return Metrics::GetShard()->Values + _slot;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "Includes.h"
+#include "Object.h"
+#include "Logger.h"
+
+namespace P3D
+{
+    Logger RefCountedBase::logger(L"System.Object");
+
+#if P3D_TRACK_OBJECTS
+    RefCountedBase* RefCountedBase::_live = NULL;
+    volatile long RefCountedBase::_liveLock = 0;
+
+    RefCountedBase::RefCountedBase()
+    {
+        while (AtomicExchange(&_liveLock, 1) != 0)
+            SpinPause();
+        _prevLive = NULL;
+        _nextLive = _live;
+        if (_live) _live->_prevLive = this;
+        _live = this;
+        AtomicExchange(&_liveLock, 0);
+    }
+
+    RefCountedBase::~RefCountedBase()
+    {
+        while (AtomicExchange(&_liveLock, 1) != 0)
+            SpinPause();
+        if (_prevLive) _prevLive->_nextLive = _nextLive;
+        else _live = _nextLive;
+        if (_nextLive) _nextLive->_prevLive = _prevLive;
+        AtomicExchange(&_liveLock, 0);
+    }
+
+    void RefCountedBase::ReportLiveObjects()
+    {
+        // objects are fully constructed here, so typeid gives the real type
+        std::map<std::string, uint> counts;
+        while (AtomicExchange(&_liveLock, 1) != 0)
+            SpinPause();
+        for (RefCountedBase* object = _live; object; object = object->_nextLive)
+            counts[typeid(*object).name()]++;
+        AtomicExchange(&_liveLock, 0);
+
+        if (counts.empty()) return;
+        for (std::map<std::string, uint>::iterator it = counts.begin(); it != counts.end(); ++it)
+            logger.warn() << L"Live at exit: " << it->second << L" x " << ToUTF16(it->first);
+    }
+#else
+    void RefCountedBase::ReportLiveObjects()
+    {
+    }
+#endif
+}
\ No newline at end of file
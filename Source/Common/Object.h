@@ -2,15 +2,105 @@
 
 #include "Atomic.h"
 
+// track live reference counted objects to report leaks at exit
+#if !defined(P3D_TRACK_OBJECTS)
+#if defined(_DEBUG)
+#define P3D_TRACK_OBJECTS 1
+#else
+#define P3D_TRACK_OBJECTS 0
+#endif
+#endif
+
 namespace P3D
 {
+    class Logger;
+
     /*
-    Base class for objects that support reference counting mechanism and live on heap.
+    Reference counting policy for objects shared between threads.
+    */
+    struct AtomicRefCount
+    {
+        static forceinline long Increment(volatile long& count)
+        {
+            return AtomicIncrement(&count);
+        }
+
+        /*
+        The only owner releases object without interlocked operation:
+        nobody else has a reference to add a new one concurrently.
+        */
+        static forceinline long Decrement(volatile long& count)
+        {
+            if (count == 1)
+            {
+                count = 0;
+                return 0;
+            }
+            return AtomicDecrement(&count);
+        }
+    };
+
+    /*
+    Reference counting policy for objects which references are never
+    added or removed concurrently, e.g. objects confined to one thread.
+    */
+    struct LocalRefCount
+    {
+        static forceinline long Increment(volatile long& count) { return ++count; }
+        static forceinline long Decrement(volatile long& count) { return --count; }
+    };
+
+    /*
+    Root of reference counted objects.
+    Disposes object when the last reference is released and tracks live objects in debug builds.
+    */
+    class RefCountedBase
+    {
+    public:
+        /*
+        Write count of live objects per type to the log.
+        Does nothing unless P3D_TRACK_OBJECTS is enabled.
+        */
+        static void ReportLiveObjects();
+
+    protected:
+#if P3D_TRACK_OBJECTS
+        RefCountedBase();
+        virtual ~RefCountedBase();
+#else
+        RefCountedBase() { }
+        virtual ~RefCountedBase() { }
+#endif
+
+        /*
+        Called when reference count reaches zero. Deletes object by default.
+        */
+        virtual void OnFinalRelease()
+        {
+            delete this;
+        }
+
+    private:
+        static Logger logger;
+
+#if P3D_TRACK_OBJECTS
+        RefCountedBase* _prevLive;
+        RefCountedBase* _nextLive;
+
+        static RefCountedBase* _live;
+        static volatile long _liveLock; // spin lock, usable before static constructors
+#endif
+    };
+
+    /*
+    Object with intrusive reference count. AddRef and Release are not virtual,
+    RefCountPolicy defines whether count is changed with interlocked operations.
     */
-    class Object
+    template<class RefCountPolicy>
+    class RefCounted : public RefCountedBase
     {
     protected:
-        virtual ~Object() 
+        virtual ~RefCounted()
         {
 #ifdef _DEBUG
             _inDestructor = true;
@@ -20,24 +110,24 @@ namespace P3D
         /*
         Construct object with reference count set to 1.
         */
-        Object()
+        RefCounted()
         {
 #ifdef _DEBUG
             _inDestructor = false;
 #endif
             _refCount = 1;
         }
-        
+
         /*
         Add one more reference to the object.
         Return new reference count.
         */
-        virtual int AddRef()
+        forceinline int AddRef()
         {
 #ifdef _DEBUG
             ASSERT(!_inDestructor);
 #endif
-            return AtomicIncrement(&_refCount);
+            return RefCountPolicy::Increment(_refCount);
         }
 
         /*
@@ -45,23 +135,35 @@ namespace P3D
         If reference count reaches zero object disposes.
         Return new reference counter.
         */
-        virtual int Release()
+        forceinline int Release()
         {
-            if (AtomicDecrement(&_refCount) == 0)
-            {
-#ifdef _DEBUG
-                _inDestructor = true;
-#endif
-                delete this;
-                return 0;
-            } else
-                return _refCount;
+            long count = RefCountPolicy::Decrement(_refCount);
+            if (count == 0)
+                OnFinalRelease();
+            return count;
         }
 
     protected:
-        ALIGNED_VARIABLE(32, volatile long, _refCount);
+        volatile long _refCount;
 #ifdef _DEBUG
         bool _inDestructor;
 #endif
     };
-}
+
+    /*
+    Base class for objects that support reference counting mechanism and live on heap.
+    References can be added and removed from any thread.
+    */
+    class Object : public RefCounted<AtomicRefCount>
+    {
+    };
+
+    /*
+    Base class for reference counted objects used by one thread at a time,
+    e.g. OpenGL resources. Saves interlocked operations on every reference.
+    Not passed to commands, AddRefIfNeeded doesn't reference them.
+    */
+    class LocalObject : public RefCounted<LocalRefCount>
+    {
+    };
+}
\ No newline at end of file
@@ -6,73 +6,246 @@ namespace P3D
     ReusableObject::ReusableObject() : _owner(NULL)
     { }
 
-    int ReusableObject::AddRef()
+    void ReusableObject::OnFinalRelease()
     {
-        int count = Object::AddRef();
         if (_owner)
-            return count - 1;
+            _owner->Collect(this);
         else
-            return count;
+            delete this;
     }
 
-    int ReusableObject::Release()
+    ObjectPoolBase* ObjectPoolBase::_pools = NULL;
+    ProfiledLock<Lock> ObjectPoolBase::_poolsLock("ObjectPool.Registry");
+
+    ObjectPoolBase::ObjectPoolBase()
+        : _threads(NULL), _fullCount(0), 
+          _lowWatermark(DefaultLowWatermark), _highWatermark(DefaultHighWatermark)
     {
-        int count = Object::Release();
-        if (count == 0 || !_owner)
-            return count;
-        if (count == 1)
+        auto_lock(_poolsLock)
         {
-            _owner->Collect(this);
-            return 0;
-        } else
-            return count - 1;
+            _nextPool = _pools;
+            _pools = this;
+        }
+    }
+
+    ObjectPoolBase::~ObjectPoolBase()
+    {
+        auto_lock(_poolsLock)
+        {
+            ObjectPoolBase** pool = &_pools;
+            while (*pool != this)
+                pool = &(*pool)->_nextPool;
+            *pool = _nextPool;
+        }
+
+        // other threads should not use the pool anymore
+        ThreadCache* cache = _threads;
+        while (cache)
+        {
+            ThreadCache* next = cache->Next;
+            ReleaseThreadCache(cache);
+            delete cache;
+            cache = next;
+        }
+        _cache.Set(NULL);
+
+        while (Magazine* magazine = _full.Pop())
+        {
+            ReleaseObjects(magazine);
+            delete magazine;
+        }
+        while (Magazine* magazine = _empty.Pop())
+            delete magazine;
+    }
+
+    ObjectPoolBase::ThreadCache* ObjectPoolBase::GetThreadCache()
+    {
+        ThreadCache* cache = _cache.Get();
+        if (cache) return cache;
+
+        cache = new ThreadCache();
+        cache->Loaded = GetEmptyMagazine();
+        cache->Previous = GetEmptyMagazine();
+        cache->Created = 0;
+        cache->Collected = 0;
+        cache->Misses = 0;
+        do
+        {
+            cache->Next = _threads;
+        } while (AtomicCASPointer((void* volatile*)&_threads, cache, cache->Next) != cache->Next);
+        _cache.Set(cache);
+        return cache;
+    }
+
+    ObjectPoolBase::Magazine* ObjectPoolBase::GetEmptyMagazine()
+    {
+        Magazine* magazine = _empty.Pop();
+        if (magazine == NULL)
+            magazine = new Magazine();
+        return magazine;
     }
 
     ReusableObject* ObjectPoolBase::CreateObject()
     {
-        ReusableObject* obj = NULL;
-        auto_lock(_lock)
+        ThreadCache* cache = GetThreadCache();
+        cache->Created++;
+
+        if (cache->Loaded->Count == 0 && cache->Previous->Count > 0)
+            std::swap(cache->Loaded, cache->Previous);
+        if (cache->Loaded->Count == 0)
         {
-            if (!_free.empty())
+            Magazine* full = _full.Pop();
+            if (full)
             {
-                obj = _free.back();
-                _free.pop_back();
+                AtomicDecrement(&_fullCount);
+                _empty.Push(cache->Previous);
+                cache->Previous = cache->Loaded;
+                cache->Loaded = full;
             }
         }
-        if (obj == NULL)
+
+        // new instance has a reference already, free objects have none
+        ReusableObject* obj;
+        if (cache->Loaded->Count > 0)
         {
+            obj = cache->Loaded->Objects[--cache->Loaded->Count];
+            obj->AddRef();
+        } else
+        {
+            cache->Misses++;
             obj = CreateObjectInstance();
             obj->SetOwner(this);
         }
         obj->ReinitializeReusable();
-        obj->AddRef();
         return obj;
     }
 
     void ObjectPoolBase::Collect(ReusableObject* obj)
     {
         obj->DeinitializeReusable();
-        auto_lock(_lock)
+
+        ThreadCache* cache = GetThreadCache();
+        cache->Collected++;
+
+        if (cache->Loaded->Count == MagazineSize)
         {
-            _free.push_back(obj);
+            if (cache->Previous->Count < MagazineSize)
+                std::swap(cache->Loaded, cache->Previous);
+            else
+            {
+                PutFullMagazine(cache->Previous);
+                cache->Previous = cache->Loaded;
+                cache->Loaded = GetEmptyMagazine();
+            }
         }
+        cache->Loaded->Objects[cache->Loaded->Count++] = obj;
     }
 
-    ObjectPoolBase::~ObjectPoolBase()
+    void ObjectPoolBase::PutFullMagazine(Magazine* magazine)
+    {
+        if (_fullCount >= (long)_highWatermark)
+        {
+            ReleaseObjects(magazine);
+            _empty.Push(magazine);
+        } else
+        {
+            AtomicIncrement(&_fullCount);
+            _full.Push(magazine);
+        }
+    }
+
+    void ObjectPoolBase::ReleaseObjects(Magazine* magazine)
     {
-        Clear();
+        for (uint i = 0; i < magazine->Count; i++)
+        {
+            magazine->Objects[i]->Destroy();
+        }
+        magazine->Count = 0;
     }
 
-    void ObjectPoolBase::Clear()
+    void ObjectPoolBase::ReleaseThreadCache(ThreadCache* cache)
+    {
+        Magazine* magazines[] = { cache->Loaded, cache->Previous };
+        for (uint i = 0; i < 2; i++)
+        {
+            // depot takes partially filled magazines too
+            if (magazines[i] == NULL) continue;
+            if (magazines[i]->Count > 0)
+                PutFullMagazine(magazines[i]);
+            else
+                _empty.Push(magazines[i]);
+        }
+        cache->Loaded = NULL;
+        cache->Previous = NULL;
+    }
+
+    void ObjectPoolBase::ReleaseThreadCaches()
     {
-        auto_lock(_lock)
+        auto_lock(_poolsLock)
         {
-            for (unsigned int i = 0; i < _free.size(); i++)
+            for (ObjectPoolBase* pool = _pools; pool; pool = pool->_nextPool)
             {
-                _free[i]->SetOwner(NULL);
-                _free[i]->Release();
+                ThreadCache* cache = pool->_cache.Get();
+                if (cache)
+                {
+                    pool->ReleaseThreadCache(cache);
+                    pool->_cache.Set(NULL);
+                }
             }
-            _free.clear();
         }
     }
+
+    void ObjectPoolBase::Clear()
+    {
+        ThreadCache* cache = _cache.Get();
+        if (cache)
+        {
+            ReleaseObjects(cache->Loaded);
+            ReleaseObjects(cache->Previous);
+        }
+
+        while (Magazine* magazine = _full.Pop())
+        {
+            AtomicDecrement(&_fullCount);
+            ReleaseObjects(magazine);
+            _empty.Push(magazine);
+        }
+    }
+
+    void ObjectPoolBase::Trim()
+    {
+        while (_fullCount > (long)_lowWatermark)
+        {
+            Magazine* magazine = _full.Pop();
+            if (magazine == NULL) break;
+            AtomicDecrement(&_fullCount);
+            ReleaseObjects(magazine);
+            _empty.Push(magazine);
+        }
+    }
+
+    void ObjectPoolBase::SetWatermarks(uint low, uint high)
+    {
+        ASSERT(low <= high);
+        _lowWatermark = low;
+        _highWatermark = high;
+    }
+
+    ObjectPoolBase::Stats ObjectPoolBase::GetStats() const
+    {
+        long created = 0, collected = 0, misses = 0;
+        for (ThreadCache* cache = _threads; cache; cache = cache->Next)
+        {
+            created += cache->Created;
+            collected += cache->Collected;
+            misses += cache->Misses;
+        }
+
+        Stats stats;
+        stats.Hits = created - misses;
+        stats.Misses = misses;
+        stats.Outstanding = created - collected;
+        stats.Depot = _fullCount;
+        return stats;
+    }
 }
\ No newline at end of file
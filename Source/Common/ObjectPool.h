@@ -3,6 +3,9 @@
 #include "Object.h"
 #include "Synchronization.h"
 #include "Singleton.h"
+#include "ThreadLocal.h"
+#include "LockFreeStack.h"
+#include "LockProfiler.h"
 
 namespace P3D
 {
@@ -10,16 +13,18 @@ namespace P3D
     class ObjectPoolBase;
     template<class T> class ObjectPool;
 
+    /*
+    Object that returns to its pool instead of deletion when the last reference is released.
+    Free objects in the pool have no references.
+    */
     class ReusableObject 
         : public Object
     {
-    public:
-        override int AddRef();
-        override int Release();
-
     protected:
         ReusableObject();
 
+        override void OnFinalRelease();
+
         virtual void ReinitializeReusable() {}
         virtual void DeinitializeReusable() {}
 
@@ -29,27 +34,116 @@ namespace P3D
         ObjectPoolBase* _owner;
 
         inline void SetOwner(ObjectPoolBase* pool) { _owner = pool; }
+        inline void Destroy() { delete this; }
     };
 
+    /*
+    Pool of free reusable objects.
+    Each thread keeps two magazines (small arrays) of free objects, most
+    creations and collections don't leave the thread. Full magazines are exchanged
+    between threads through the lock-free depot. Depot is trimmed to the high watermark
+    on collection and can be trimmed to the low watermark with Trim.
+    */
     class ObjectPoolBase
     {
         friend class ReusableObject;
     public:
+        enum
+        {
+            MagazineSize = 32,
+            DefaultLowWatermark = 2, // full magazines left in depot by Trim
+            DefaultHighWatermark = 32 // max full magazines in depot
+        };
+
+        struct Stats
+        {
+            long Hits; // objects taken from the pool
+            long Misses; // objects created because pool was empty
+            long Outstanding; // objects currently in use
+            long Depot; // full magazines in depot
+        };
+
+        ObjectPoolBase();
         ~ObjectPoolBase();
 
         ReusableObject* CreateObject();
+
+        /*
+        Release free objects in depot and in the calling thread magazines.
+        */
         void Clear();
 
+        /*
+        Release full magazines in depot above low watermark.
+        */
+        void Trim();
+
+        void SetWatermarks(uint low, uint high);
+
+        /*
+        Return pool statistics. Values are approximate while other threads use the pool.
+        */
+        Stats GetStats() const;
+
+        /*
+        Return magazines of the calling thread to the depots of all pools.
+        Called when thread finishes.
+        */
+        static void ReleaseThreadCaches();
+
     protected:
         virtual ReusableObject* CreateObjectInstance() = 0;
 
     private:
+        struct Magazine : 
+            public LockFreeStackNode
+        {
+            uint Count;
+            ReusableObject* Objects[MagazineSize];
+
+            Magazine() : Count(0) {}
+        };
+
+        /*
+        Magazines and counters of one thread.
+        Never deleted while pool lives, so the stats of finished threads are kept.
+        */
+        struct ThreadCache
+        {
+            Magazine* Loaded;
+            Magazine* Previous;
+            long Created;
+            long Collected;
+            long Misses;
+            ThreadCache* Next;
+        };
+
         void Collect(ReusableObject* obj);
 
+        ThreadCache* GetThreadCache();
+        Magazine* GetEmptyMagazine();
+
+        /*
+        Put full magazine into depot or release its objects if depot is above high watermark.
+        */
+        void PutFullMagazine(Magazine* magazine);
+
+        void ReleaseObjects(Magazine* magazine);
+        void ReleaseThreadCache(ThreadCache* cache);
+
     private:
-        Lock _lock;
-        typedef std::vector<ReusableObject*> ObjectList;
-        ObjectList _free;
+        ThreadLocal<ThreadCache> _cache;
+        ThreadCache* volatile _threads; // all thread caches ever created
+        LockFreeStack<Magazine> _full;
+        LockFreeStack<Magazine> _empty;
+        volatile long _fullCount;
+        uint _lowWatermark;
+        uint _highWatermark;
+
+        // registry of pools for ReleaseThreadCaches
+        ObjectPoolBase* _nextPool;
+        static ObjectPoolBase* _pools;
+        static ProfiledLock<Lock> _poolsLock;
     };
 
     /*
@@ -0,0 +1,178 @@
+#include "Includes.h"
+#include "ObjectWithTags.h"
+
+namespace P3D
+{
+    SpinLock ObjectWithTags::_writeLocks[ObjectWithTags::WriteLocks];
+    const char* volatile ObjectWithTags::_tagNames[ObjectWithTags::MaxTagNames];
+
+    uint ObjectWithTags::HashName(const char* name)
+    {
+        // FNV-1a
+        uint hash = 2166136261u;
+        for (; *name; name++)
+            hash = (hash ^ uint(byte(*name))) * 16777619u;
+        return hash;
+    }
+
+    TagKey ObjectWithTags::InternTag(const char* name)
+    {
+        uint hash = HashName(name);
+        char* copy = NULL;
+        for (uint i = 0; i < MaxTagNames; i++)
+        {
+            uint index = (hash + i) & (MaxTagNames - 1);
+            const char* current = _tagNames[index];
+            if (current == NULL)
+            {
+                // names are never removed, so the slot is ours or taken by another name forever
+                if (copy == NULL) copy = strdup(name);
+                current = (const char*)AtomicCASPointer((void* volatile*)&_tagNames[index], copy, NULL);
+                if (current == NULL) return index + 1;
+            }
+            if (strcmp(current, name) == 0)
+            {
+                free(copy);
+                return index + 1;
+            }
+        }
+        ASSERT(!"Too many tag names");
+        free(copy);
+        return 0;
+    }
+
+    TagKey ObjectWithTags::FindTag(const char* name)
+    {
+        uint hash = HashName(name);
+        for (uint i = 0; i < MaxTagNames; i++)
+        {
+            uint index = (hash + i) & (MaxTagNames - 1);
+            const char* current = _tagNames[index];
+            if (current == NULL) return 0;
+            if (strcmp(current, name) == 0) return index + 1;
+        }
+        return 0;
+    }
+
+    ObjectWithTags::Block* ObjectWithTags::CreateBlock(uint slots)
+    {
+        size_t size = sizeof(Block) + (slots - 1) * sizeof(Slot);
+        Block* block = (Block*)malloc(size);
+        memset(block, 0, size);
+        return block;
+    }
+
+    ObjectWithTags::Slot* ObjectWithTags::FindSlot(TagKey key, bool create)
+    {
+        // slots are only taken, so the first free slot on the way means there is no such key
+        Block* first = _tags;
+        if (first == NULL)
+        {
+            if (!create) return NULL;
+            first = CreateBlock(InlineSlots);
+            WriteMemoryBarrier();
+            _tags = first;
+        }
+
+        for (uint i = 0; i < InlineSlots; i++)
+        {
+            Slot& slot = first->Slots[i];
+            if (slot.Key == key || slot.Key == 0) return create || slot.Key == key ? &slot : NULL;
+        }
+
+        Block* last = first;
+        for (Block* block = first->Next; block; block = block->Next)
+        {
+            for (uint i = 0; i < HashedSlots; i++)
+            {
+                Slot& slot = block->Slots[(key + i) & (HashedSlots - 1)];
+                if (slot.Key == key || slot.Key == 0) return create || slot.Key == key ? &slot : NULL;
+            }
+            last = block;
+        }
+
+        if (!create) return NULL;
+        Block* block = CreateBlock(HashedSlots);
+        WriteMemoryBarrier();
+        last->Next = block;
+        return &block->Slots[key & (HashedSlots - 1)];
+    }
+
+    void ObjectWithTags::AddTag(TagKey key, void* value, TagDisposeFunction disposeFunction)
+    {
+        if (key == 0) return;
+
+        Slot old = { 0, NULL, NULL };
+        auto_lock(GetWriteLock(this))
+        {
+            Slot* slot = FindSlot(key, value != NULL);
+            if (slot != NULL)
+            {
+                if (slot->Key == key && slot->Data != value)
+                {
+                    old.Data = slot->Data;
+                    old.DisposeFunc = slot->DisposeFunc;
+                }
+                slot->DisposeFunc = disposeFunction;
+                slot->Data = value;
+                if (slot->Key != key)
+                {
+                    // publish the key after the data
+                    WriteMemoryBarrier();
+                    slot->Key = key;
+                }
+            }
+        }
+
+        // dispose functions may use tags, don't call them under the lock
+        DisposeTag(old);
+    }
+
+    void ObjectWithTags::DisposeTag(Slot& slot)
+    {
+        if (slot.Data != NULL && slot.DisposeFunc != NULL)
+            slot.DisposeFunc(slot.Data);
+        slot.Data = NULL;
+        slot.DisposeFunc = NULL;
+    }
+
+    void ObjectWithTags::DisposeTags(bool destroy)
+    {
+        if (destroy)
+        {
+            // nobody else uses the object being destroyed
+            Block* block = _tags;
+            _tags = NULL;
+            uint slots = InlineSlots;
+            while (block)
+            {
+                for (uint i = 0; i < slots; i++)
+                    DisposeTag(block->Slots[i]);
+                Block* next = block->Next;
+                free(block);
+                block = next;
+                slots = HashedSlots;
+            }
+            return;
+        }
+
+        std::vector<Slot> removed;
+        auto_lock(GetWriteLock(this))
+        {
+            uint slots = InlineSlots;
+            for (Block* block = _tags; block; block = block->Next, slots = HashedSlots)
+            {
+                for (uint i = 0; i < slots; i++)
+                {
+                    Slot& slot = block->Slots[i];
+                    if (slot.Data == NULL) continue;
+                    removed.push_back(slot);
+                    slot.Data = NULL;
+                }
+            }
+        }
+
+        for (uint i = 0; i < removed.size(); i++)
+            DisposeTag(removed[i]);
+    }
+}
\ No newline at end of file
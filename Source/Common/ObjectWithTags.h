@@ -1,114 +1,178 @@
 #pragma once
 
 #include "Synchronization.h"
+#include "Atomic.h"
 
 namespace P3D
 {
+    /*
+    Interned tag name. Keys of the same name are equal, 0 is invalid key.
+    Cache keys of frequently used tags to skip the name lookup.
+    */
+    typedef uint TagKey;
+
     /*
     Object that can hold orbitary string -> void* mapping.
+    Storage is allocated with the first tag. Readers don't lock,
+    writers of the same object are serialized.
     */
     class ObjectWithTags
     {
     public:
+        ObjectWithTags()
+            : _tags(NULL)
+        { }
+
         /*
         Disposes all tags.
         */
         virtual ~ObjectWithTags()
         {
-            AutoLock lock(_lock);
-            for (TagIterator it = _tags.begin(); it != _tags.end(); ++it)
-                DisposeTag(it->second);
-            _tags.clear();
+            DisposeTags(true);
         }
 
+        /*
+        Return key for the name, name is registered if it is new.
+        */
+        static TagKey InternTag(const char* name);
+
+        /*
+        Return key for the name or 0 if it was never registered.
+        */
+        static TagKey FindTag(const char* name);
+
         /*
         Adds new tag. Rewrites previous one with the same name.
         */
+        void AddTag(TagKey key, void* value, TagDisposeFunction disposeFunction = NULL);
+
         inline void AddTag(const char* key, void* value, TagDisposeFunction disposeFunction = NULL)
         {
-            AutoLock lock(_lock);
-            TagIterator it = _tags.find(key);
-            if (it != _tags.end())
-            {
-                DisposeTag(it->second);
-                if (value == NULL)
-                    _tags.erase(it);
-                else
-                {
-                    it->second.Data = value;
-                    it->second.DisposeFunc = disposeFunction;
-                }
-            } else
-            {
-                Tag tag;
-                tag.Data = value;
-                tag.DisposeFunc = disposeFunction;
-                _tags[key] = tag;
-            }
+            AddTag(InternTag(key), value, disposeFunction);
         }
 
         /*
         Remove tag if it exists.
         */
-        inline void RemoveTag(const char* key) { AddTag(key, NULL); }
+        inline void RemoveTag(TagKey key) { AddTag(key, NULL); }
+
+        inline void RemoveTag(const char* key)
+        {
+            TagKey atom = FindTag(key);
+            if (atom != 0) RemoveTag(atom);
+        }
 
         /*
         Remove all tags.
         */
         inline void RemoveAllTags()
         {
-            AutoLock lock(_lock);
-            for (TagIterator it = _tags.begin(); it != _tags.end(); ++it)
-                DisposeTag(it->second);
-            _tags.clear();
+            DisposeTags(false);
         }
 
         /*
         Return tag as void*.
         */
-        void* GetTag(const char* key) const
+        void* GetTag(TagKey key) const
         {
             return GetTagImpl(key);
         }
 
+        void* GetTag(const char* key) const
+        {
+            return GetTagImpl(FindTag(key));
+        }
+
         /*
         Return tag or NULL. Makes typecast.
         */
         template<class T>
-        T* GetTagWithType(const char* key) const
+        T* GetTagWithType(TagKey key) const
         {
             return static_cast<T*>(GetTagImpl(key));
         }
 
+        template<class T>
+        T* GetTagWithType(const char* key) const
+        {
+            return static_cast<T*>(GetTagImpl(FindTag(key)));
+        }
+
     private:
-        struct Tag
+        enum
+        {
+            InlineSlots = 4, // most objects have a few tags, they are scanned linearly
+            HashedSlots = 16, // slots of further blocks, power of two
+            WriteLocks = 64, // stripes of writer locks shared by all objects
+            MaxTagNames = 4096 // power of two
+        };
+
+        /*
+        Key of a slot is set once, removed tag leaves slot with its key and NULL data.
+        So reader that has found the key never sees value of another tag.
+        */
+        struct Slot
         {
-            void* Data;
+            volatile TagKey Key;
+            void* volatile Data;
             TagDisposeFunction DisposeFunc;
         };
 
-        typedef std::map<std::string, Tag> TagsMap;
-        typedef TagsMap::const_iterator TagConstIterator;
-        typedef TagsMap::iterator TagIterator;
+        /*
+        First block has InlineSlots, other blocks are open addressing tables of HashedSlots.
+        Blocks are never freed before the object.
+        */
+        struct Block
+        {
+            Block* volatile Next;
+            Slot Slots[1];
+        };
 
-        TagsMap _tags;
+        static Block* CreateBlock(uint slots);
+        static SpinLock& GetWriteLock(const void* object) { return _writeLocks[(size_t(object) >> 4) % WriteLocks]; }
 
-    private:
-        inline void DisposeTag(Tag& tag)
+        inline void* GetTagImpl(TagKey key) const
         {
-            if (tag.Data != NULL && tag.DisposeFunc != NULL)
-                tag.DisposeFunc(tag.Data);
-            tag.Data = tag.DisposeFunc = NULL;
-        }
+            if (key == 0) return NULL;
+            Block* block = _tags;
+            if (block == NULL) return NULL;
 
-        inline void* GetTagImpl(const char* key) const
-        {
-            AutoLock lock(_lock);
-            TagConstIterator it = _tags.find(key);
-            if (it == _tags.end()) return NULL;
-            else return it->second.Data;
+            for (uint i = 0; i < InlineSlots; i++)
+            {
+                TagKey slotKey = block->Slots[i].Key;
+                if (slotKey == key) return block->Slots[i].Data;
+                if (slotKey == 0) return NULL;
+            }
+
+            for (block = block->Next; block; block = block->Next)
+            {
+                for (uint i = 0; i < HashedSlots; i++)
+                {
+                    const Slot& slot = block->Slots[(key + i) & (HashedSlots - 1)];
+                    if (slot.Key == key) return slot.Data;
+                    if (slot.Key == 0) break;
+                }
+            }
+            return NULL;
         }
 
-        mutable Lock _lock;
+        /*
+        Return slot with the key or free slot for it. Called under the write lock.
+        */
+        Slot* FindSlot(TagKey key, bool create);
+
+        static void DisposeTag(Slot& slot);
+        void DisposeTags(bool destroy);
+
+        static uint HashName(const char* name);
+
+        // copy would share the storage
+        ObjectWithTags(const ObjectWithTags&);
+        ObjectWithTags& operator=(const ObjectWithTags&);
+
+        Block* volatile _tags;
+
+        static SpinLock _writeLocks[WriteLocks];
+        static const char* volatile _tagNames[MaxTagNames]; // open addressing, key is index + 1
     };
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "StdCommands.h"
 #include "Synchronization.h"
 #include "TemplateTricks.h"
+#include "Object.h"
+#include "SmartPointer.h"
 
 namespace P3D
 {
@@ -20,17 +22,35 @@ namespace P3D
         template<class T>
         class ThreadSafetyPolicy;
 
+        /*
+        Writers are serialized by the lock.
+        Readers only announce the short window between loading a shared pointer
+        and adding reference to it, writer waits for the window to close
+        before it releases the pointer it has replaced.
+        */
         template<>
         class ThreadSafetyPolicy<ThreadSafe>
         {
         public:
             typedef AutoLock AutoLockType; 
 
+            ThreadSafetyPolicy() : _readers(0) { }
+
             void Enter() { _lock.Enter(); }
             void Leave() { _lock.Leave(); }
             Lock& GetLockable() {  return _lock; }
+
+            void BeginRead() { AtomicIncrement(&_readers); }
+            void EndRead() { AtomicDecrement(&_readers); }
+            void WaitForReaders()
+            {
+                while (_readers != 0)
+                    SpinPause();
+            }
+
         private:
             Lock _lock;
+            volatile long _readers;
         };
 
         template<>
@@ -42,11 +62,18 @@ namespace P3D
             void Enter() { }
             void Leave() { }
             int GetLockable() { return 0; }
+
+            void BeginRead() { }
+            void EndRead() { }
+            void WaitForReaders() { }
         };
     }
 
     /*
     Base template class for event dispatcher.
+    Listeners are kept in immutable list which is replaced on every change,
+    so dispatch doesn't lock or allocate, it just takes reference to the current list.
+    Listeners added or removed during dispatch take effect from the next event.
     Usage:
     class MyObservable : public Observable<MyListener, ThreadSafe>
     {
@@ -66,6 +93,15 @@ namespace P3D
     class Observable
     {
     public:
+        Observable()
+            : _listeners(NULL)
+        { }
+
+        ~Observable()
+        {
+            if (_listeners) _listeners->Release();
+        }
+
         /*
         Add listener to the list.
         Adding one listener twice is not allower.
@@ -74,7 +110,14 @@ namespace P3D
         {
             MTPolicy::AutoLockType autolock(_mt.GetLockable());
             AddRefIfNeeded(listener);
-            _listeners.push_back(std::make_pair(listener, ResolveContext(executionContext)));
+            ListenerList* list = new ListenerList();
+            if (_listeners)
+            {
+                list->Items.reserve(_listeners->Items.size() + 1);
+                list->Items = _listeners->Items;
+            }
+            list->Items.push_back(std::make_pair(listener, ResolveContext(executionContext)));
+            Publish(list);
         }
 
         /*
@@ -83,11 +126,21 @@ namespace P3D
         void RemoveListener(ListenerType* listener)
         {
             MTPolicy::AutoLockType autolock(_mt.GetLockable());
-            for (ListenersVector::iterator it = _listeners.begin(); it != _listeners.end(); ++it)
+            if (_listeners == NULL) return;
+            ListenersVector& items = _listeners->Items;
+            for (ListenersVector::iterator it = items.begin(); it != items.end(); ++it)
             {
                 if (it->first == listener)
                 {
-                    _listeners.erase(it);
+                    ListenerList* list = NULL;
+                    if (items.size() > 1)
+                    {
+                        list = new ListenerList();
+                        list->Items.reserve(items.size() - 1);
+                        list->Items.insert(list->Items.end(), items.begin(), it);
+                        list->Items.insert(list->Items.end(), it + 1, items.end());
+                    }
+                    Publish(list);
                     ReleaseIfNeeded(listener);
                     return;
                 }
@@ -100,9 +153,12 @@ namespace P3D
         void RemoveAllListeners()
         {
             MTPolicy::AutoLockType autolock(_mt.GetLockable());
-            for (ListenersVector::iterator it = _listeners.begin(); it != _listeners.end(); ++it)
+            if (_listeners == NULL) return;
+            // keep the list alive till listeners are released
+            SmartPointer<ListenerList> old(_listeners);
+            Publish(NULL);
+            for (ListenersVector::iterator it = old->Items.begin(); it != old->Items.end(); ++it)
                 ReleaseIfNeeded(it->first);
-            _listeners.clear();
         }
 
         /*
@@ -110,19 +166,17 @@ namespace P3D
         */
         bool HasListeners() const
         {
-            MTPolicy::AutoLockType autolock(_mt.GetLockable());
-            return !_listeners.empty();
+            return _listeners != NULL;
         }
 
     protected:
 #define DISPATCH_IMPL(...) \
         {\
-            ListenersVector listenersCopy; \
-            { \
-                MTPolicy::AutoLockType autolock(_mt.GetLockable()); \
-                listenersCopy = _listeners; \
-            } \
-            for (ListenersVector::iterator it = listenersCopy.begin(); it != listenersCopy.end(); ++it) \
+            if (_listeners == NULL) return; \
+            SmartPointer<ListenerList> listeners; \
+            listeners.Attach(AcquireListeners()); \
+            if (!listeners) return; \
+            for (ListenersVector::iterator it = listeners->Items.begin(); it != listeners->Items.end(); ++it) \
             {\
                 if (it->second == NULL)\
                     ((*(it->first)).*(method))(__VA_ARGS__);\
@@ -155,7 +209,48 @@ namespace P3D
 
     private:
         typedef std::vector<std::pair<ListenerType*, ExecutionContext*> > ListenersVector;
-        ListenersVector _listeners;
+
+        /*
+        Snapshot of listeners, never changed after it is published.
+        */
+        class ListenerList : public Object
+        {
+        public:
+            ListenersVector Items;
+        };
+
+        /*
+        Return referenced current list or NULL if there are no listeners.
+        */
+        ListenerList* AcquireListeners()
+        {
+            _mt.BeginRead();
+            ListenerList* list = _listeners;
+            if (list) list->AddRef();
+            _mt.EndRead();
+            return list;
+        }
+
+        /*
+        Replace current list, should be called under the writer lock.
+        Empty list is published as NULL.
+        */
+        void Publish(ListenerList* list)
+        {
+            ListenerList* old = (ListenerList*)AtomicExchangePointer((void* volatile*)&_listeners, list);
+            if (old)
+            {
+                // readers that loaded the old pointer have referenced it by now
+                _mt.WaitForReaders();
+                old->Release();
+            }
+        }
+
+        // copying would share the list without reference
+        Observable(const Observable&);
+        Observable& operator=(const Observable&);
+
+        ListenerList* volatile _listeners;
 
         typedef Internal::ThreadSafetyPolicy<ThreadSafePolicy> MTPolicy;
         mutable MTPolicy _mt;
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef P3D_POSIX
+#error The file should be included under POSIX only.
+#endif
+
+namespace P3D
+{
+    /*
+    Atomically set's *var = newValue and return previous value of var.
+    */
+    inline long AtomicExchange(long volatile* var, long newValue)
+    {
+        return __atomic_exchange_n(var, newValue, __ATOMIC_SEQ_CST);
+    }
+
+    /*
+    Atomcally do this:
+        old = *var
+        if (*var == compare)
+            *var = swap
+        return old
+    */
+    inline long AtomicCAS(long volatile* var, long swap, long compare)
+    {
+        return __sync_val_compare_and_swap(var, compare, swap);
+    }
+
+    /*
+    Atomically set's *var = newValue and return previous value of var.
+    */
+    inline void* AtomicExchangePointer(void* volatile* var, void* newValue)
+    {
+        return __atomic_exchange_n(var, newValue, __ATOMIC_SEQ_CST);
+    }
+
+    /*
+    Pointer version of AtomicCAS.
+    */
+    inline void* AtomicCASPointer(void* volatile* var, void* swap, void* compare)
+    {
+        return __sync_val_compare_and_swap(var, compare, swap);
+    }
+
+    inline int64 AtomicCAS64(int64 volatile* var, int64 swap, int64 compare)
+    {
+        return __sync_val_compare_and_swap(var, compare, swap);
+    }
+
+    /*
+    Atomically increments variable and return its new value.
+    */
+    inline long AtomicIncrement(long volatile* var)
+    {
+        return __sync_add_and_fetch(var, 1);
+    }
+
+    /*
+    Atomically decrement variable and return its new value.
+    */
+    inline long AtomicDecrement(long volatile* var)
+    {
+        return __sync_sub_and_fetch(var, 1);
+    }
+
+    // compiler barriers, x86 doesn't reorder loads with loads and stores with stores
+    inline void MemoryFence() { __asm__ __volatile__("" ::: "memory"); }
+    inline void ReadMemoryBarrier() { __asm__ __volatile__("" ::: "memory"); }
+    inline void WriteMemoryBarrier() { __asm__ __volatile__("" ::: "memory"); }
+
+    /*
+    Full processor memory fence: no loads or stores are reordered across it.
+    */
+    inline void ProcessorMemoryFence() { __sync_synchronize(); }
+
+    /*
+    Hint to the processor that the thread is spinning.
+    */
+    inline void SpinPause() { __builtin_ia32_pause(); }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef P3D_POSIX
+#error The file should be included under POSIX only.
+#endif
+
+namespace P3D
+{
+    namespace Implementation
+    {
+        /*
+        Thin wrappers of Linux futex syscall.
+        */
+        class Futex
+        {
+        public:
+            /*
+            Sleep while *address == value. Return false on timeout.
+            Wakes spuriously, callers should recheck the condition.
+            */
+            static bool Wait(volatile int* address, int value, uint timeout = INFINITE)
+            {
+                struct timespec time;
+                struct timespec* timePtr = NULL;
+                if (timeout != INFINITE)
+                {
+                    time.tv_sec = timeout / 1000;
+                    time.tv_nsec = (timeout % 1000) * 1000000;
+                    timePtr = &time;
+                }
+                long res = syscall(SYS_futex, (int*)address, FUTEX_WAIT_PRIVATE, value, timePtr, NULL, 0);
+                return !(res == -1 && errno == ETIMEDOUT);
+            }
+
+            /*
+            Wake up to count threads sleeping on the address.
+            */
+            static void Wake(volatile int* address, int count = 1)
+            {
+                syscall(SYS_futex, (int*)address, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+            }
+        };
+
+        /*
+        Return monotonic time in msecs.
+        */
+        inline uint64 GetMonotonicTime()
+        {
+            struct timespec time;
+            clock_gettime(CLOCK_MONOTONIC, &time);
+            return uint64(time.tv_sec) * 1000 + time.tv_nsec / 1000000;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,257 @@
+#pragma once
+
+#ifndef P3D_POSIX
+#error The file should be included under POSIX only.
+#endif
+
+#include "Futex.h"
+#include "Thread.h"
+
+namespace P3D
+{
+    namespace Implementation
+    {
+        /*
+        Events are eventfd descriptors so groups of them can be waited with poll.
+        Counter of eventfd is nonzero while the event is signaled. Auto-reset event
+        is consumed by reading the counter, only one of the waiters succeeds.
+        */
+        class Event
+        {
+        public:
+            struct EventData
+            {
+                int fd;
+                bool autoreset;
+            };
+
+            typedef EventData* EventHandle;
+            static const int MaxWaitHandles = 64;
+
+            inline static EventHandle CreateEventHandle(bool autoreset, bool initialState)
+            {
+                int fd = eventfd(initialState ? 1 : 0, EFD_NONBLOCK | EFD_CLOEXEC);
+                if (fd == -1) return NULL;
+                EventData* data = new EventData();
+                data->fd = fd;
+                data->autoreset = autoreset;
+                return data;
+            }
+            inline static void DestroyEventHandle(EventHandle handle)
+            {
+                ASSERT(handle != NULL);
+                close(handle->fd);
+                delete handle;
+            }
+            inline static void Signal(EventHandle handle)
+            {
+                ASSERT(handle != NULL);
+                uint64 value = 1;
+                ssize_t res = write(handle->fd, &value, sizeof(value));
+                (void)res;
+            }
+            inline static void Clear(EventHandle handle)
+            {
+                ASSERT(handle != NULL);
+                TryConsume(handle->fd);
+            }
+            inline static bool WaitOne(EventHandle handle, uint timeout)
+            {
+                ASSERT(handle != NULL);
+                return WaitN(&handle, 1, timeout, false) == -1;
+            }
+            inline static int WaitN(EventHandle* handles, uint count, uint timeout, bool waitAll)
+            {
+                ASSERT(count <= MaxWaitHandles);
+                bool seen[MaxWaitHandles] = { false };
+                uint64 deadline = GetMonotonicTime() + timeout;
+                while (true)
+                {
+                    // to wait for all poll only events not seen signaled yet
+                    struct pollfd fds[MaxWaitHandles];
+                    uint indices[MaxWaitHandles];
+                    uint polled = 0;
+                    for (uint i = 0; i < count; i++)
+                    {
+                        if (waitAll && seen[i]) continue;
+                        fds[polled].fd = handles[i]->fd;
+                        fds[polled].events = POLLIN;
+                        fds[polled].revents = 0;
+                        indices[polled++] = i;
+                    }
+
+                    int wait = -1;
+                    if (timeout != INFINITE)
+                    {
+                        uint64 now = GetMonotonicTime();
+                        wait = now < deadline ? int(deadline - now) : 0;
+                    }
+                    if (poll(fds, polled, wait) < 0 && errno != EINTR)
+                        return -1;
+
+                    uint seenCount = 0;
+                    for (uint i = 0; i < polled; i++)
+                    {
+                        if ((fds[i].revents & POLLIN) == 0) continue;
+                        uint index = indices[i];
+                        // auto-reset event could be taken by another waiter, then poll again
+                        if (!waitAll && TryAcquire(handles[index]))
+                            return index;
+                        seen[index] = true;
+                    }
+                    for (uint i = 0; i < count; i++)
+                        if (seen[i]) seenCount++;
+
+                    if (waitAll && seenCount == count)
+                    {
+                        if (TryAcquireAll(handles, count))
+                            return 0;
+                        memset(seen, 0, sizeof(seen));
+                    }
+
+                    if (timeout != INFINITE && GetMonotonicTime() >= deadline)
+                        return -1;
+                }
+            }
+            inline static int WaitAny(EventHandle* handles, uint count, uint timeout)
+            {
+                return WaitN(handles, count, timeout, false);
+            }
+            inline static int WaitAll(EventHandle* handles, uint count, uint timeout)
+            {
+                return WaitN(handles, count, timeout, true);
+            }
+
+        private:
+            /*
+            Reset the counter. Return true if it was nonzero.
+            */
+            inline static bool TryConsume(int fd)
+            {
+                uint64 value;
+                return read(fd, &value, sizeof(value)) == sizeof(value);
+            }
+
+            inline static bool IsSignaled(int fd)
+            {
+                struct pollfd pfd = { fd, POLLIN, 0 };
+                return poll(&pfd, 1, 0) == 1;
+            }
+
+            inline static bool TryAcquire(EventHandle handle)
+            {
+                return handle->autoreset ? TryConsume(handle->fd) : IsSignaled(handle->fd);
+            }
+
+            /*
+            Acquire all events, signal back already consumed ones if some event was lost.
+            */
+            inline static bool TryAcquireAll(EventHandle* handles, uint count)
+            {
+                for (uint i = 0; i < count; i++)
+                {
+                    if (TryAcquire(handles[i])) continue;
+                    for (uint j = 0; j < i; j++)
+                        if (handles[j]->autoreset) Signal(handles[j]);
+                    return false;
+                }
+                return true;
+            }
+        };
+
+        /*
+        Recursive futex lock with adaptive spinning.
+        State is 0 if unlocked, 1 if locked, 2 if locked and there are sleeping waiters.
+        Thread spins before sleeping, spin count adapts to how long the lock was held
+        last times it was acquired by spinning.
+        */
+        class Lock
+        {
+        public:
+            struct DataType
+            {
+                volatile int state;
+                volatile Thread::ThreadID owner;
+                int recursion;
+                int maxSpin;
+                int spin; // adaptive spin count
+            };
+
+            static void Initialize(DataType* cs, int spinCount)
+            {
+                cs->state = 0;
+                cs->owner = 0;
+                cs->recursion = 0;
+                cs->maxSpin = spinCount;
+                cs->spin = spinCount / 4;
+            }
+            static void Free(DataType* cs)
+            {
+                ASSERT(cs->state == 0);
+            }
+            static void Enter(DataType* cs)
+            {
+                Thread::ThreadID self = Thread::GetCurrentThreadID();
+                if (cs->owner == self)
+                {
+                    cs->recursion++;
+                    return;
+                }
+
+                if (__sync_val_compare_and_swap(&cs->state, 0, 1) != 0)
+                    EnterContended(cs);
+                cs->owner = self;
+                cs->recursion = 1;
+            }
+            static void Leave(DataType* cs)
+            {
+                ASSERT(cs->owner == Thread::GetCurrentThreadID());
+                if (--cs->recursion > 0) return;
+                cs->owner = 0;
+                if (__sync_fetch_and_sub(&cs->state, 1) != 1)
+                {
+                    // there are sleepers, wake one
+                    cs->state = 0;
+                    __sync_synchronize();
+                    Futex::Wake(&cs->state);
+                }
+            }
+            static bool TryEnter(DataType* cs)
+            {
+                Thread::ThreadID self = Thread::GetCurrentThreadID();
+                if (cs->owner == self)
+                {
+                    cs->recursion++;
+                    return true;
+                }
+                if (__sync_val_compare_and_swap(&cs->state, 0, 1) != 0)
+                    return false;
+                cs->owner = self;
+                cs->recursion = 1;
+                return true;
+            }
+
+        private:
+            static void EnterContended(DataType* cs)
+            {
+                // spin while the owner is likely to release the lock soon
+                int limit = cs->spin * 2 + 16;
+                if (limit > cs->maxSpin) limit = cs->maxSpin;
+                for (int i = 0; i < limit; i++)
+                {
+                    if (cs->state == 0 && __sync_val_compare_and_swap(&cs->state, 0, 1) == 0)
+                    {
+                        cs->spin += (i - cs->spin) / 8;
+                        return;
+                    }
+                    __builtin_ia32_pause();
+                }
+                cs->spin += (limit - cs->spin) / 8;
+
+                // sleep, state 2 tells the owner to wake us
+                while (__sync_lock_test_and_set(&cs->state, 2) != 0)
+                    Futex::Wait(&cs->state, 2);
+            }
+        };
+    }
+}
\ No newline at end of file
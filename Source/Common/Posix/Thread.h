@@ -0,0 +1,181 @@
+#pragma once
+
+#ifndef P3D_POSIX
+#error The file should be included under POSIX only.
+#endif
+
+#include "Futex.h"
+
+namespace P3D
+{
+    namespace Implementation
+    {
+        class Thread
+        {
+        private:
+            struct ThreadRecord;
+        public:
+            typedef pid_t ThreadID;
+            typedef ThreadRecord* ThreadHandle;
+            typedef int (*ThreadProc)(void* param1, void* param2);
+            typedef int TLSIndex;
+
+            // ThreadLocal slots, pthread keys are slower than __thread
+            static const int MaxTLSSlots = 256;
+
+            static ThreadID GetCurrentThreadID()
+            {
+                // kernel thread ID is cached, syscall is not cheap
+                static __thread ThreadID id = 0;
+                if (id == 0)
+                    id = (ThreadID)syscall(SYS_gettid);
+                return id;
+            }
+            static bool RunThread(ThreadHandle* handle, ThreadID* id, ThreadProc proc, void* param1, void* param2)
+            {
+                ASSERT(handle != NULL);
+                ASSERT(id != NULL);
+                ASSERT(proc != NULL);
+                ThreadRecord* record = new ThreadRecord(proc, param1, param2);
+
+                pthread_attr_t attr;
+                pthread_attr_init(&attr);
+                pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+                int res = pthread_create(&record->thread, &attr, _Run, record);
+                pthread_attr_destroy(&attr);
+                if (res != 0)
+                {
+                    *handle = NULL;
+                    *id = 0;
+                    delete record;
+                    return false;
+                }
+
+                // kernel ID is known only inside the new thread
+                while (record->started == 0)
+                    Futex::Wait(&record->started, 0);
+                *id = record->id;
+                *handle = record;
+                return true;
+            }
+            static void DestroyThreadHandle(ThreadHandle handle)
+            {
+                if (handle) handle->Release();
+            }
+            static bool Join(ThreadHandle handle, uint timeout)
+            {
+                // thread holds its own reference to the record, so it stays valid
+                // till the owner calls DestroyThreadHandle after the join
+                if (handle == NULL) return true;
+
+                uint64 deadline = GetMonotonicTime() + timeout;
+                while (handle->finished == 0)
+                {
+                    uint wait = INFINITE;
+                    if (timeout != INFINITE)
+                    {
+                        uint64 now = GetMonotonicTime();
+                        if (now >= deadline) return false;
+                        wait = uint(deadline - now);
+                    }
+                    Futex::Wait(&handle->finished, 0, wait);
+                }
+                return true;
+            }
+            static void YieldExecution()
+            {
+                sched_yield();
+            }
+            static uint GetProcessorCount()
+            {
+                long count = sysconf(_SC_NPROCESSORS_ONLN);
+                return count > 0 ? (uint)count : 1;
+            }
+            static bool SetAffinity(ThreadHandle handle, uint64 mask)
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (uint i = 0; i < 64 && i < CPU_SETSIZE; i++)
+                    if (mask & (uint64(1) << i)) CPU_SET(i, &set);
+                pthread_t thread = handle ? handle->thread : pthread_self();
+                return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+            }
+            static void SetCurrentThreadName(const char* name)
+            {
+                // names are limited to 15 characters
+                char buffer[16];
+                strncpy(buffer, name, sizeof(buffer) - 1);
+                buffer[sizeof(buffer) - 1] = 0;
+                pthread_setname_np(pthread_self(), buffer);
+            }
+            static TLSIndex AllocTLSIndex()
+            {
+                static volatile int count = 0;
+                int index = __sync_fetch_and_add(&count, 1);
+                if (index >= MaxTLSSlots)
+                {
+                    // slots are indexed unchecked, running on would corrupt memory;
+                    // ThreadLocals are created during static initialization, logging may be not ready
+                    fprintf(stderr, "Out of ThreadLocal slots, MaxTLSSlots (%d) is too small.\n", MaxTLSSlots);
+                    abort();
+                }
+                return index;
+            }
+            static void SetTLSValue(TLSIndex index, void* value)
+            {
+                GetTLSSlots()[index] = value;
+            }
+            static void* GetTLSValue(TLSIndex index)
+            {
+                return GetTLSSlots()[index];
+            }
+
+        private:
+            static void** GetTLSSlots()
+            {
+                static __thread void* slots[MaxTLSSlots];
+                return slots;
+            }
+
+            /*
+            Threads are detached, the record is shared by the thread and the owner of the handle.
+            */
+            struct ThreadRecord
+            {
+                ThreadRecord(ThreadProc p, void* p1, void* p2) 
+                    : proc(p), param1(p1), param2(p2), id(0), started(0), finished(0), refs(2) {}
+
+                void Release()
+                {
+                    if (__sync_sub_and_fetch(&refs, 1) == 0)
+                        delete this;
+                }
+
+                pthread_t thread;
+                ThreadProc proc;
+                void* param1;
+                void* param2;
+                volatile ThreadID id;
+                volatile int started;
+                volatile int finished;
+                volatile int refs;
+            };
+
+            static void* _Run(void* param)
+            {
+                ThreadRecord* record = static_cast<ThreadRecord*>(param);
+                record->id = GetCurrentThreadID();
+                __sync_synchronize();
+                record->started = 1;
+                Futex::Wake(&record->started);
+
+                int res = record->proc(record->param1, record->param2);
+
+                record->finished = 1;
+                Futex::Wake(&record->finished, INT_MAX);
+                record->Release();
+                return (void*)(long)res;
+            }
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "Includes.h"
+#include "Profiler.h"
+#include "Thread.h"
+#include "Config.h"
+
+namespace P3D
+{
+    Logger Profiler::logger(L"System.Profiler");
+
+    volatile bool Profiler::_enabled = false;
+    ThreadLocal<Profiler::ThreadBuffer> Profiler::_buffer;
+    Profiler::ThreadBuffer* volatile Profiler::_threads = NULL;
+
+    uint64 Profiler::_frameStart = 0;
+    float Profiler::_frameTime = 0;
+    Profiler::SummaryMap Profiler::_frameTotals;
+    std::vector<Profiler::SummaryEntry> Profiler::_summary;
+
+    String Profiler::_captureFile;
+    uint Profiler::_captureFrames = 0;
+    std::vector<Profiler::CaptureEvent> Profiler::_capture;
+
+    Profiler::ThreadBuffer* Profiler::CreateThreadBuffer()
+    {
+        // buffers are never deleted, collector may read them after the thread exits
+        ThreadBuffer* buffer = new ThreadBuffer();
+        buffer->Head = 0;
+        buffer->Tail = 0;
+        buffer->ThreadID = (long)Thread::GetCurrentThreadID();
+        do
+        {
+            buffer->Next = _threads;
+        } while (AtomicCASPointer((void* volatile*)&_threads, buffer, buffer->Next) != buffer->Next);
+        _buffer.Set(buffer);
+        return buffer;
+    }
+
+    void Profiler::Configure()
+    {
+        Config& config = Config::GetInstance();
+        SetEnabled(config.ReadBool("Profiler", "enabled", false));
+
+        String trace = config.ReadWideString("Profiler", "trace");
+        if (!trace.empty())
+        {
+            SetEnabled(true);
+            StartCapture(trace, config.ReadInt("Profiler", "traceFrames", 300));
+        }
+    }
+
+    void Profiler::BeginFrame()
+    {
+        _frameStart = TimeCounter::GetTickCount();
+    }
+
+    void Profiler::Collect(ThreadBuffer* buffer)
+    {
+        long head = buffer->Head;
+        ReadMemoryBarrier();
+
+        // skip scopes already overwritten by the owner
+        if (head - buffer->Tail > BufferSize)
+            buffer->Tail = head - BufferSize;
+
+        uint first = _capture.size();
+        for (long i = buffer->Tail; i < head; i++)
+        {
+            const Event& event = buffer->Events[i & (BufferSize - 1)];
+            CaptureEvent captured;
+            captured.Scope = event;
+            captured.ThreadID = buffer->ThreadID;
+            _capture.push_back(captured);
+        }
+
+        // owner could overwrite the slots while they were copied, drop them,
+        // slot of Head may be being written right now and it aliases Head - BufferSize
+        ReadMemoryBarrier();
+        long overwritten = buffer->Head - BufferSize + 1;
+        uint valid = first;
+        for (long i = buffer->Tail; i < head; i++)
+        {
+            if (i >= overwritten)
+                _capture[valid++] = _capture[first + (i - buffer->Tail)];
+        }
+        _capture.resize(valid);
+        buffer->Tail = head;
+    }
+
+    void Profiler::EndFrame()
+    {
+        uint64 now = TimeCounter::GetTickCount();
+        double msecsPerTick = 1000.0 / TimeCounter::GetTicksPerSecond();
+        _frameTime = float((now - _frameStart) * msecsPerTick);
+
+        // events of this frame are appended to the capture, without capture they are dropped after summary
+        uint first = _capture.size();
+        for (ThreadBuffer* buffer = _threads; buffer; buffer = buffer->Next)
+            Collect(buffer);
+
+        for (SummaryMap::iterator it = _frameTotals.begin(); it != _frameTotals.end(); ++it)
+        {
+            it->second.Calls = 0;
+            it->second.Total = 0;
+            it->second.Max = 0;
+        }
+        for (uint i = first; i < _capture.size(); i++)
+        {
+            const Event& event = _capture[i].Scope;
+            float time = float((event.End - event.Begin) * msecsPerTick);
+            SummaryEntry& entry = _frameTotals[event.Name];
+            entry.Name = event.Name;
+            entry.Calls++;
+            entry.Total += time;
+            if (time > entry.Max) entry.Max = time;
+        }
+
+        _summary.clear();
+        for (SummaryMap::iterator it = _frameTotals.begin(); it != _frameTotals.end(); ++it)
+        {
+            if (it->second.Calls > 0)
+                _summary.push_back(it->second);
+        }
+        std::sort(_summary.begin(), _summary.end(), SummaryGreater());
+        if (_summary.size() > MaxSummaryEntries)
+            _summary.resize(MaxSummaryEntries);
+
+        if (!IsCapturing())
+        {
+            _capture.clear();
+            return;
+        }
+
+        // frame itself is shown as a scope of the collecting thread
+        CaptureEvent frame;
+        frame.Scope.Name = "Frame";
+        frame.Scope.Begin = _frameStart;
+        frame.Scope.End = now;
+        frame.ThreadID = (long)Thread::GetCurrentThreadID();
+        _capture.push_back(frame);
+
+        if (_captureFrames > 0 && --_captureFrames == 0)
+            StopCapture();
+    }
+
+    void Profiler::StartCapture(const String& file, uint frames)
+    {
+        _captureFile = file;
+        _captureFrames = frames;
+        _capture.clear();
+    }
+
+    void Profiler::StopCapture()
+    {
+        if (!IsCapturing()) return;
+        WriteCapture();
+        _captureFile.clear();
+        _capture.clear();
+    }
+
+    void Profiler::WriteCapture()
+    {
+        FILE* file = _wfopen(_captureFile.c_str(), L"wt");
+        if (!file)
+        {
+            logger.error() << L"Can't create trace file " << _captureFile;
+            return;
+        }
+
+        // Chrome trace format: complete events ("X") with time and duration in microseconds
+        uint64 start = _capture.empty() ? 0 : _capture[0].Scope.Begin;
+        for (uint i = 0; i < _capture.size(); i++)
+            if (_capture[i].Scope.Begin < start) start = _capture[i].Scope.Begin;
+        double usecsPerTick = 1000000.0 / TimeCounter::GetTicksPerSecond();
+
+        fprintf(file, "{\"traceEvents\":[\n");
+        for (uint i = 0; i < _capture.size(); i++)
+        {
+            const CaptureEvent& event = _capture[i];
+            fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%ld}%s\n",
+                event.Scope.Name,
+                (event.Scope.Begin - start) * usecsPerTick,
+                (event.Scope.End - event.Scope.Begin) * usecsPerTick,
+                event.ThreadID,
+                i + 1 < _capture.size() ? "," : "");
+        }
+        fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+        fclose(file);
+
+        logger.info() << L"Trace with " << (uint)_capture.size() << L" scopes is written to " << _captureFile;
+    }
+}
\ No newline at end of file
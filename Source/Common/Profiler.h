@@ -0,0 +1,214 @@
+#pragma once
+
+#include "Synchronization.h"
+#include "ThreadLocal.h"
+#include "TimeCounter.h"
+#include "Atomic.h"
+#include "Logger.h"
+
+namespace P3D
+{
+    /*
+    Scope profiler.
+    Each thread writes finished scopes to its own ring buffer without locks,
+    main thread collects them once per frame in EndFrame. Collected scopes are
+    summed per name into the frame summary and can be captured to Chrome trace
+    JSON (open it in chrome://tracing). Old scopes are overwritten if the thread
+    finishes more than BufferSize scopes between two EndFrame calls.
+    Use PROFILE_SCOPE macro to mark scopes.
+    */
+    class Profiler
+    {
+    public:
+        enum
+        {
+            BufferSize = 8192, // scopes per thread, power of two
+            MaxSummaryEntries = 64
+        };
+
+        /*
+        Finished scope. Name should be a string literal.
+        */
+        struct Event
+        {
+            const char* Name;
+            uint64 Begin;
+            uint64 End;
+        };
+
+        /*
+        Time spent in scopes with the same name during the last frame.
+        Times are inclusive (nested scopes are counted in parent too).
+        */
+        struct SummaryEntry
+        {
+            const char* Name;
+            uint Calls;
+            float Total; // msecs
+            float Max; // msecs
+        };
+
+        /*
+        Enable or disable recording. Disabled scopes cost one check of the flag.
+        */
+        static void SetEnabled(bool enabled) { _enabled = enabled; }
+        static bool IsEnabled() { return _enabled; }
+
+        /*
+        Mark the start of the frame.
+        */
+        static void BeginFrame();
+
+        /*
+        Collect scopes of all threads finished since BeginFrame,
+        build the frame summary and add scopes to the capture.
+        Should be called from one thread only.
+        */
+        static void EndFrame();
+
+        /*
+        Return summary of the last frame sorted by total time.
+        */
+        static const std::vector<SummaryEntry>& GetFrameSummary() { return _summary; }
+
+        /*
+        Return duration of the last frame in msecs.
+        */
+        static float GetFrameTime() { return _frameTime; }
+
+        /*
+        Start collecting scopes for the trace. Capture is written by StopCapture
+        or automatically after given count of frames if it is not zero.
+        */
+        static void StartCapture(const String& file, uint frames = 0);
+
+        /*
+        Write captured scopes to the file as Chrome trace JSON and stop capturing.
+        */
+        static void StopCapture();
+
+        static bool IsCapturing() { return !_captureFile.empty(); }
+
+        /*
+        Read settings from the config and start capture if the trace file is set.
+        */
+        static void Configure();
+
+    private:
+        friend class ProfileScope;
+
+        struct ThreadBuffer
+        {
+            Event Events[BufferSize];
+            volatile long Head; // count of written events, written by the owner thread only
+            long Tail; // count of collected events, used by the collecting thread only
+            long ThreadID;
+            ThreadBuffer* Next;
+        };
+
+        struct CaptureEvent
+        {
+            Event Scope;
+            long ThreadID;
+        };
+
+        struct NameLess
+        {
+            bool operator()(const char* a, const char* b) const { return strcmp(a, b) < 0; }
+        };
+        typedef std::map<const char*, SummaryEntry, NameLess> SummaryMap;
+
+        struct SummaryGreater
+        {
+            bool operator()(const SummaryEntry& a, const SummaryEntry& b) const { return a.Total > b.Total; }
+        };
+
+        static ThreadBuffer* GetThreadBuffer()
+        {
+            ThreadBuffer* buffer = _buffer.Get();
+            return buffer ? buffer : CreateThreadBuffer();
+        }
+
+        static ThreadBuffer* CreateThreadBuffer();
+
+        /*
+        Copy scope finished by current thread to its buffer.
+        */
+        static void Record(ThreadBuffer* buffer, const char* name, uint64 begin, uint64 end)
+        {
+            Event& event = buffer->Events[buffer->Head & (BufferSize - 1)];
+            event.Name = name;
+            event.Begin = begin;
+            event.End = end;
+            // event should be complete before the collector sees it
+            WriteMemoryBarrier();
+            buffer->Head++;
+        }
+
+        static void Collect(ThreadBuffer* buffer);
+        static void WriteCapture();
+
+        static Logger logger;
+
+        static volatile bool _enabled;
+        static ThreadLocal<ThreadBuffer> _buffer;
+        static ThreadBuffer* volatile _threads;
+
+        static uint64 _frameStart;
+        static float _frameTime;
+        static SummaryMap _frameTotals;
+        static std::vector<SummaryEntry> _summary;
+
+        static String _captureFile;
+        static uint _captureFrames;
+        static std::vector<CaptureEvent> _capture;
+    };
+
+    /*
+    Records time between construction and destruction to the profiler.
+    */
+    class ProfileScope
+    {
+    public:
+        ProfileScope(const char* name)
+        {
+            if (!Profiler::_enabled)
+            {
+                _buffer = NULL;
+                return;
+            }
+            _buffer = Profiler::GetThreadBuffer();
+            _name = name;
+            _begin = TimeCounter::GetTickCount();
+        }
+
+        ~ProfileScope()
+        {
+            if (!_buffer) return;
+            uint64 end = TimeCounter::GetTickCount();
+            Profiler::Record(_buffer, _name, _begin, end);
+        }
+
+    private:
+        Profiler::ThreadBuffer* _buffer;
+        const char* _name;
+        uint64 _begin;
+    };
+}
+
+// Set P3D_PROFILE to 0 to strip profiler scopes out.
+#ifndef P3D_PROFILE
+#   define P3D_PROFILE 1
+#endif
+
+#define P3D_PROFILE_CONCAT2(a, b) a##b
+#define P3D_PROFILE_CONCAT(a, b) P3D_PROFILE_CONCAT2(a, b)
+
+// Profile the rest of the enclosing block. Usage:
+// PROFILE_SCOPE("Terrain.CalculateLOD");
+// Name should be a string literal, it is stored by pointer.
+#if P3D_PROFILE
+#   define PROFILE_SCOPE(name) ::P3D::ProfileScope P3D_PROFILE_CONCAT(__profileScope, __LINE__)(name)
+#else
+#   define PROFILE_SCOPE(name) ((void)0)
+#endif
\ No newline at end of file
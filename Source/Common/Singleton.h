@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Synchronization.h"
+#include "Atomic.h"
 #include "AtExitManager.h"
 
 namespace P3D
@@ -16,10 +17,16 @@ namespace P3D
 
         static T& GetInstance()
         {
+            // instance is never changed after creation till exit, don't lock each time
+            if (_instance) return *_instance;
+
             AutoLock lock(_lock);
             if (!_instance) 
             {
-                _instance = new T();
+                // publish fully constructed instance only
+                T* instance = new T();
+                WriteMemoryBarrier();
+                _instance = instance;
                 AtExitManager::RegisterAtExit(&Singleton<T>::OnExit);
             }
             return *_instance;
@@ -0,0 +1,83 @@
+#include "Includes.h"
+#include "SlabAllocator.h"
+#include <malloc.h>
+
+namespace P3D
+{
+    SlabAllocator* volatile SlabAllocator::_allocators = NULL;
+
+    SlabAllocator::SlabAllocator(const char* name, size_t blockSize, size_t chunkSize)
+        : _name(name), _free(NULL), _top(NULL), _end(NULL), _chunks(0), _used(0)
+    {
+        // block holds free list link and keeps the alignment
+        if (blockSize < sizeof(FreeBlock)) blockSize = sizeof(FreeBlock);
+        _blockSize = (blockSize + Alignment - 1) & ~size_t(Alignment - 1);
+        _chunkSize = chunkSize < _blockSize ? _blockSize : chunkSize;
+
+        do
+        {
+            _next = _allocators;
+        } while (AtomicCASPointer((void* volatile*)&_allocators, this, _next) != _next);
+    }
+
+    void SlabAllocator::AllocateChunk()
+    {
+        // the rest of the previous chunk is too small for a block and is lost
+        _top = (char*)_aligned_malloc(_chunkSize, Alignment);
+        _end = _top + _chunkSize / _blockSize * _blockSize;
+        _chunks++;
+    }
+
+    SlabAllocator::Stats SlabAllocator::GetStats() const
+    {
+        Stats stats;
+        auto_lock(_lock)
+        {
+            stats.Name = _name;
+            stats.BlockSize = _blockSize;
+            stats.Chunks = _chunks;
+            stats.Used = _used;
+            stats.Reserved = _chunks * _chunkSize;
+            stats.Free = uint(_chunks * (_chunkSize / _blockSize)) - _used;
+        }
+        return stats;
+    }
+
+    void SlabAllocator::GetAllStats(std::vector<Stats>& stats)
+    {
+        stats.clear();
+        for (SlabAllocator* allocator = _allocators; allocator; allocator = allocator->_next)
+            stats.push_back(allocator->GetStats());
+    }
+
+    void SlabAllocator::WriteReport(Logger& log)
+    {
+        std::vector<Stats> stats;
+        GetAllStats(stats);
+        size_t total = 0;
+        for (uint i = 0; i < stats.size(); i++)
+        {
+            if (stats[i].Chunks == 0) continue;
+            log.info() << L"Slab " << ToUTF16(stats[i].Name) << L"/" << stats[i].BlockSize << L": "
+                << stats[i].Used << L" used, " << stats[i].Free << L" free, "
+                << stats[i].Chunks << L" chunks (" << stats[i].Reserved / 1024 << L" Kb).";
+            total += stats[i].Reserved;
+        }
+        log.info() << L"Slabs total: " << total / 1024 << L" Kb.";
+    }
+
+    SlabAllocator* SlabClassAllocator::CreateSlab(uint cls)
+    {
+        auto_lock(_lock)
+        {
+            // slabs are created once and live till exit, like their chunks
+            if (_slabs[cls - 1] == NULL)
+            {
+                SlabAllocator* slab = new SlabAllocator(_name, cls * SlabAllocator::Alignment);
+                WriteMemoryBarrier();
+                _slabs[cls - 1] = slab;
+            }
+        }
+        return _slabs[cls - 1];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "Synchronization.h"
+#include "Logger.h"
+
+namespace P3D
+{
+    /*
+    Allocator of fixed size blocks. Blocks are cut from contiguous chunks and
+    never move, free blocks are kept in the list for reuse.
+    Objects allocated together lie together, there is no per-block heap header.
+    Memory of chunks is kept till exit.
+    */
+    class SlabAllocator
+    {
+    public:
+        enum
+        {
+            Alignment = 16,
+            DefaultChunkSize = 64 * 1024
+        };
+
+        struct Stats
+        {
+            const char* Name;
+            uint BlockSize;
+            uint Chunks;
+            uint Used; // blocks in use
+            uint Free; // blocks in free list or not cut from chunk yet
+            size_t Reserved; // bytes taken from the heap
+        };
+
+        SlabAllocator(const char* name, size_t blockSize, size_t chunkSize = DefaultChunkSize);
+
+        void* Allocate()
+        {
+            auto_lock(_lock)
+            {
+                if (_free)
+                {
+                    FreeBlock* block = _free;
+                    _free = block->Next;
+                    _used++;
+                    return block;
+                }
+                if (size_t(_end - _top) < _blockSize) AllocateChunk();
+                void* block = _top;
+                _top += _blockSize;
+                _used++;
+                return block;
+            }
+            return NULL;
+        }
+
+        void Deallocate(void* p)
+        {
+            if (p == NULL) return;
+            auto_lock(_lock)
+            {
+                FreeBlock* block = (FreeBlock*)p;
+                block->Next = _free;
+                _free = block;
+                _used--;
+            }
+        }
+
+        Stats GetStats() const;
+        size_t GetBlockSize() const { return _blockSize; }
+
+        /*
+        Return statistics of all allocators.
+        */
+        static void GetAllStats(std::vector<Stats>& stats);
+
+        /*
+        Write statistics of all allocators to the log.
+        */
+        static void WriteReport(Logger& log);
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* Next;
+        };
+
+        void AllocateChunk();
+
+        const char* _name;
+        size_t _blockSize;
+        size_t _chunkSize;
+        mutable SpinLock _lock;
+        FreeBlock* _free;
+        char* _top; // not cut part of the last chunk
+        char* _end;
+        uint _chunks;
+        uint _used;
+        SlabAllocator* _next;
+
+        static SlabAllocator* volatile _allocators; // lock-free registry
+    };
+
+    /*
+    Allocator for class hierarchy: derived classes of different sizes
+    get slabs of their size class. Bigger objects go to the heap.
+    Used by DECLARE_SLAB_NEW / DEFINE_SLAB_NEW.
+    */
+    class SlabClassAllocator
+    {
+    public:
+        enum
+        {
+            MaxBlockSize = 4096,
+            SizeClasses = MaxBlockSize / SlabAllocator::Alignment
+        };
+
+        explicit SlabClassAllocator(const char* name)
+            : _name(name)
+        {
+            memset((void*)_slabs, 0, sizeof(_slabs));
+        }
+
+        void* Allocate(size_t size)
+        {
+            if (size > MaxBlockSize) return ::operator new(size);
+            uint cls = uint((size + SlabAllocator::Alignment - 1) / SlabAllocator::Alignment);
+            SlabAllocator* slab = _slabs[cls - 1];
+            if (slab == NULL) slab = CreateSlab(cls);
+            return slab->Allocate();
+        }
+
+        void Deallocate(void* p, size_t size)
+        {
+            if (size > MaxBlockSize)
+            {
+                ::operator delete(p);
+                return;
+            }
+            uint cls = uint((size + SlabAllocator::Alignment - 1) / SlabAllocator::Alignment);
+            _slabs[cls - 1]->Deallocate(p);
+        }
+
+    private:
+        SlabAllocator* CreateSlab(uint cls);
+
+        const char* _name;
+        SlabAllocator* volatile _slabs[SizeClasses];
+        SpinLock _lock;
+    };
+
+    // Declare class-level operators new and delete taking memory from slabs.
+    // Class should have virtual destructor if derived objects are deleted by pointer to base.
+    #define DECLARE_SLAB_NEW() \
+        static void* operator new(size_t size); \
+        static void operator delete(void* p, size_t size);
+
+    // Define operators declared by DECLARE_SLAB_NEW in the module of the class.
+    #define DEFINE_SLAB_NEW(Class, name) \
+        static ::P3D::SlabClassAllocator g_##Class##Slabs(name); \
+        void* Class::operator new(size_t size) { return g_##Class##Slabs.Allocate(size); } \
+        void Class::operator delete(void* p, size_t size) { g_##Class##Slabs.Deallocate(p, size); }
+}
\ No newline at end of file
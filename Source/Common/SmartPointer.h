@@ -1,5 +1,14 @@
 #pragma once
 
+// compiler supports rvalue references
+#if !defined(P3D_HAS_RVALUE_REFERENCES)
+#if (defined(_MSC_VER) && _MSC_VER >= 1600) || __cplusplus >= 201103L
+#define P3D_HAS_RVALUE_REFERENCES 1
+#else
+#define P3D_HAS_RVALUE_REFERENCES 0
+#endif
+#endif
+
 namespace P3D
 {
     template <class T>
@@ -45,6 +54,26 @@ namespace P3D
             if (p != NULL) p->AddRef();
         }
 
+#if P3D_HAS_RVALUE_REFERENCES
+        // takes the reference without touching the count
+        SmartPointer(SmartPointer<T>&& lp) throw()
+        {
+            p = lp.p;
+            lp.p = NULL;
+        }
+
+        SmartPointer<T>& operator=(SmartPointer<T>&& lp) throw()
+        {
+            if (this != &lp)
+            {
+                if (p) p->Release();
+                p = lp.p;
+                lp.p = NULL;
+            }
+            return *this;
+        }
+#endif
+
         ~SmartPointer() throw()
         {
             if (p) p->Release();
@@ -140,6 +169,14 @@ namespace P3D
             p = NULL;
             return pt;
         }
+
+        // Exchange pointers without touching reference counts
+        void Swap(SmartPointer<T>& other) throw()
+        {
+            T* pt = p;
+            p = other.p;
+            other.p = pt;
+        }
         void CopyTo(T** ppT) throw()
         {
             ASSERT(ppT != NULL);
@@ -3,8 +3,13 @@
 #if defined(P3D_WINDOWS)
 #include "Windows/Synchronization.h"
 #include "Windows/Thread.h"
+#elif defined(P3D_POSIX)
+#include "Posix/Synchronization.h"
+#include "Posix/Thread.h"
 #endif
 
+#include "Atomic.h"
+
 // Synchronization primitives
 
 namespace P3D
@@ -183,6 +188,132 @@ namespace P3D
         Impl::DataType _cs;
     };
 
+    /*
+    Lock for short critical sections that never sleeps in the kernel.
+    Waiters spin and then yield the processor. Not recursive.
+    */
+    class SpinLock
+    {
+    public:
+        enum { SpinsBeforeYield = 1000 };
+
+        inline SpinLock() : _state(0)
+        { }
+
+        inline void Enter()
+        {
+            if (AtomicExchange(&_state, 1) == 0) return;
+            EnterContended();
+        }
+
+        inline void Leave()
+        {
+            ASSERT(_state == 1);
+            WriteMemoryBarrier();
+            _state = 0;
+        }
+
+        inline bool TryEnter()
+        {
+            return _state == 0 && AtomicExchange(&_state, 1) == 0;
+        }
+
+    private:
+        void EnterContended()
+        {
+            uint spins = 0;
+            do
+            {
+                // wait for release without locking the bus
+                while (_state != 0)
+                {
+                    if (++spins < SpinsBeforeYield)
+                        SpinPause();
+                    else
+                    {
+                        Implementation::Thread::YieldExecution();
+                        spins = 0;
+                    }
+                }
+            } while (AtomicExchange(&_state, 1) != 0);
+        }
+
+        volatile long _state;
+    };
+
+    /*
+    Reader-writer lock for read-mostly data.
+    Any count of readers can hold the lock in shared mode, writer holds it exclusively.
+    Waiting writer blocks new readers so writers are not starved.
+    Not recursive in either mode.
+    */
+    class RWLock
+    {
+    public:
+        inline RWLock() : _readers(0), _writer(0), _drained(Event::AutoReset)
+        { }
+
+        /*
+        Lock in exclusive mode.
+        */
+        inline void Enter()
+        {
+            _writerLock.Enter();
+            _writer = 1;
+            // readers increment the counter before they check the flag
+            ProcessorMemoryFence();
+            while (_readers != 0)
+                _drained.Wait();
+        }
+
+        inline void Leave()
+        {
+            ASSERT(_writer == 1);
+            _writer = 0;
+            _writerLock.Leave();
+        }
+
+        inline bool TryEnter()
+        {
+            if (!_writerLock.TryEnter()) return false;
+            _writer = 1;
+            ProcessorMemoryFence();
+            if (_readers == 0) return true;
+            Leave();
+            return false;
+        }
+
+        /*
+        Lock in shared mode.
+        */
+        inline void EnterShared()
+        {
+            while (true)
+            {
+                AtomicIncrement(&_readers);
+                if (_writer == 0) return;
+
+                // back off and sleep till the writer leaves
+                LeaveShared();
+                _writerLock.Enter();
+                _writerLock.Leave();
+            }
+        }
+
+        inline void LeaveShared()
+        {
+            // signal may be stale, writer rechecks the counter
+            if (AtomicDecrement(&_readers) == 0 && _writer != 0)
+                _drained.Signal();
+        }
+
+    private:
+        volatile long _readers;
+        volatile long _writer;
+        Lock _writerLock; // held by the writer, serializes writers and parks readers
+        Event _drained; // signaled by the last reader when writer waits
+    };
+
     /*
     Mixin object that owns lock.
     */
@@ -196,47 +327,126 @@ namespace P3D
         LockType _lock;
     };
 
+    /*
+    Enter the lock. Overloaded by lock types which track acquisition site.
+    */
+    template<class Lockable>
+    inline void EnterLock(Lockable& lock, const char* site)
+    {
+        lock.Enter();
+    }
+
+    /*
+    Base of scoped locks, allows auto_lock to hold a guard of any lock type.
+    */
+    class AutoLockBase
+    {
+    public:
+        // required to implement auto_lock(cs)
+        operator bool() const { return false; }
+    };
+
     /*
     Locks critical section in the constructor and unlocks it in the desctructor.
     */
     template<class Lockable>
-    class AutoLockTemplate
+    class AutoLockTemplate : public AutoLockBase
     {
-        Lockable* critSectionPtr;
+        mutable Lockable* critSectionPtr;
     public:
-        AutoLockTemplate(Lockable& handle)
+        AutoLockTemplate(Lockable& handle, const char* site = NULL)
         {
             critSectionPtr = &handle;
             ASSERT(critSectionPtr != NULL);
-            critSectionPtr->Enter();
+            EnterLock(*critSectionPtr, site);
         }
 
         AutoLockTemplate(ObjectWithLock<Lockable>* object)
         {
             critSectionPtr = &object->GetLock();
             ASSERT(critSectionPtr != NULL);
-            critSectionPtr->Enter();
+            EnterLock(*critSectionPtr, NULL);
         }
 
-        AutoLockTemplate(ObjectWithLock<Lockable>& object)
+        AutoLockTemplate(ObjectWithLock<Lockable>& object, const char* site = NULL)
         {
             critSectionPtr = &object.GetLock();
             ASSERT(critSectionPtr != NULL);
-            critSectionPtr->Enter();
+            EnterLock(*critSectionPtr, site);
+        }
+
+        // ownership of the lock is moved to the copy
+        AutoLockTemplate(const AutoLockTemplate& other)
+        {
+            critSectionPtr = other.critSectionPtr;
+            other.critSectionPtr = NULL;
         }
 
         ~AutoLockTemplate()
         {
-            critSectionPtr->Leave();
+            if (critSectionPtr)
+                critSectionPtr->Leave();
         }
 
-        // required to implement auto_lock(cs)
-        operator int() const { return 0; }
+    private:
+        AutoLockTemplate& operator=(const AutoLockTemplate&);
     };
 
     typedef AutoLockTemplate<Lock> AutoLock;
 
-    // Neat define for AutoLock. Usage:
-    // auto_lock (lock) { ... } <=> { AutoLock locker(lock); ... }
-    #define auto_lock(cs) if (::P3D::AutoLock __lock__ = ::P3D::AutoLock((cs))) { UNREACHABLE(); } else 
+    /*
+    Holds RWLock in shared mode while in scope.
+    */
+    class SharedLock : public AutoLockBase
+    {
+        mutable RWLock* _lock;
+    public:
+        SharedLock(RWLock& lock)
+        {
+            _lock = &lock;
+            _lock->EnterShared();
+        }
+
+        // ownership of the lock is moved to the copy
+        SharedLock(const SharedLock& other)
+        {
+            _lock = other._lock;
+            other._lock = NULL;
+        }
+
+        ~SharedLock()
+        {
+            if (_lock)
+                _lock->LeaveShared();
+        }
+
+    private:
+        SharedLock& operator=(const SharedLock&);
+    };
+
+    template<class Lockable>
+    inline AutoLockTemplate<Lockable> MakeAutoLock(Lockable& lock, const char* site)
+    {
+        return AutoLockTemplate<Lockable>(lock, site);
+    }
+
+    template<class Lockable>
+    inline AutoLockTemplate<Lockable> MakeAutoLock(ObjectWithLock<Lockable>& object, const char* site)
+    {
+        return AutoLockTemplate<Lockable>(object, site);
+    }
+
+    #define P3D_STRINGIZE2(x) #x
+    #define P3D_STRINGIZE(x) P3D_STRINGIZE2(x)
+
+    // source location passed to the lock, used by contention profiler
+    #define P3D_LOCK_SITE __FILE__ "(" P3D_STRINGIZE(__LINE__) ")"
+
+    // Neat define for AutoLock. Works with any lock type (Lock, SpinLock, RWLock, ...). Usage:
+    // auto_lock (lock) { ... } <=> { AutoLockTemplate<LockType> locker(lock); ... }
+    #define auto_lock(cs) if (const ::P3D::AutoLockBase& __lock__ = ::P3D::MakeAutoLock((cs), P3D_LOCK_SITE)) { UNREACHABLE(); } else 
+
+    // Lock RWLock in shared mode. Usage:
+    // auto_lock_shared (lock) { ... } <=> { SharedLock locker(lock); ... }
+    #define auto_lock_shared(cs) if (const ::P3D::AutoLockBase& __lock__ = ::P3D::SharedLock((cs))) { UNREACHABLE(); } else 
 }
\ No newline at end of file
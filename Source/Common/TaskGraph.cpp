@@ -0,0 +1,181 @@
+#include "Includes.h"
+#include "TaskGraph.h"
+
+namespace P3D
+{
+    Logger TaskGraph::logger(L"System.TaskGraph");
+
+    /*
+    Executes task command and starts continuations.
+    */
+    class TaskGraph::TaskCommand :
+        public Command
+    {
+    public:
+        TaskCommand(TaskGraph* graph, TaskID id) : _graph(graph), _id(id)
+        { }
+
+        override void Execute(ExecutionContext* context)
+        {
+            // continuations should be started even if the task failed
+            try
+            {
+                _graph->_tasks[_id].Cmd->Execute(context);
+            }
+            catch (Exception& exc)
+            {
+                logger.error() << L"Unhandled exception in task: " << exc;
+            }
+            catch (std::exception& exc)
+            {
+                logger.error() << L"Unhandled exception in task: " << exc.what();
+            }
+            catch (...)
+            {
+                logger.error() << L"Unknown unhandled exception in task.";
+            }
+            _graph->Finish(_id);
+        }
+
+        /*
+        Pool is stopping: count the task as finished so Run doesn't wait forever.
+        Continuations are rejected by the pool too.
+        */
+        override void Discard()
+        {
+            logger.warn() << L"Task was discarded by the pool";
+            _graph->Finish(_id);
+        }
+
+    private:
+        TaskGraph* _graph;
+        TaskID _id;
+    };
+
+    TaskGraph::TaskGraph()
+        : _pool(NULL), _remaining(0), _checked(true)
+    {
+    }
+
+    TaskGraph::~TaskGraph()
+    {
+        Clear();
+    }
+
+    TaskGraph::TaskID TaskGraph::AddTask(Command* command)
+    {
+        ASSERT(command != NULL);
+        ASSERT(_remaining == 0);
+
+        Task task;
+        task.Cmd = command;
+        task.Cmd->AddRef();
+        task.Runner = new TaskCommand(this, _tasks.size());
+        task.Dependencies = 0;
+        task.Pending = 0;
+        _tasks.push_back(task);
+        return _tasks.size() - 1;
+    }
+
+    void TaskGraph::AddDependency(TaskID before, TaskID after)
+    {
+        ASSERT(before < _tasks.size() && after < _tasks.size());
+        ASSERT(before != after);
+        ASSERT(_remaining == 0);
+
+        _tasks[before].Continuations.push_back(after);
+        _tasks[after].Dependencies++;
+        _checked = false;
+    }
+
+    void TaskGraph::Clear()
+    {
+        ASSERT(_remaining == 0);
+        for (uint i = 0; i < _tasks.size(); i++)
+        {
+            _tasks[i].Runner->Release();
+            _tasks[i].Cmd->Release();
+        }
+        _tasks.clear();
+        _checked = true;
+    }
+
+    bool TaskGraph::HasCycles() const
+    {
+        // Kahn's algorithm: all tasks should be reachable from roots
+        std::vector<long> pending(_tasks.size());
+        std::vector<TaskID> ready;
+        for (uint i = 0; i < _tasks.size(); i++)
+        {
+            pending[i] = _tasks[i].Dependencies;
+            if (pending[i] == 0) ready.push_back(i);
+        }
+
+        uint visited = 0;
+        while (!ready.empty())
+        {
+            TaskID id = ready.back();
+            ready.pop_back();
+            visited++;
+            const std::vector<TaskID>& next = _tasks[id].Continuations;
+            for (uint i = 0; i < next.size(); i++)
+                if (--pending[next[i]] == 0) ready.push_back(next[i]);
+        }
+        return visited != _tasks.size();
+    }
+
+    void TaskGraph::Run(ThreadPool* pool)
+    {
+        if (_tasks.empty()) return;
+
+        if (!_checked)
+        {
+            if (HasCycles())
+            {
+                logger.error() << L"Task graph has cycles, it won't be run";
+                return;
+            }
+            _checked = true;
+        }
+
+        _pool = pool;
+        for (uint i = 0; i < _tasks.size(); i++)
+            _tasks[i].Pending = _tasks[i].Dependencies;
+        _remaining = _tasks.size();
+
+        for (uint i = 0; i < _tasks.size(); i++)
+        {
+            if (_tasks[i].Dependencies == 0)
+                Schedule(i);
+        }
+
+        while (_remaining > 0)
+        {
+            if (!_pool->ExecutePendingCommand())
+                Thread::YieldExecution();
+        }
+        _pool = NULL;
+    }
+
+    void TaskGraph::Schedule(TaskID id)
+    {
+        TaskCommand* runner = _tasks[id].Runner;
+        if (_pool)
+        {
+            runner->AddRef(); // pool releases it after execution
+            _pool->Invoke(runner);
+        } else
+            runner->Execute(CONTEXT_CALL_NOW);
+    }
+
+    void TaskGraph::Finish(TaskID id)
+    {
+        const std::vector<TaskID>& next = _tasks[id].Continuations;
+        for (uint i = 0; i < next.size(); i++)
+        {
+            if (AtomicDecrement(&_tasks[next[i]].Pending) == 0)
+                Schedule(next[i]);
+        }
+        AtomicDecrement(&_remaining);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+namespace P3D
+{
+    /*
+    Graph of commands with dependencies executed by the thread pool.
+    Task starts when all tasks it depends on are finished, independent tasks overlap.
+    Graph is built once and can be run many times (e.g. each frame)
+    without allocations.
+    */
+    class TaskGraph
+    {
+    public:
+        typedef uint TaskID;
+
+        TaskGraph();
+        ~TaskGraph();
+
+        /*
+        Add task executing the command. AddRefs the command.
+        Return ID of the task to be used in AddDependency.
+        */
+        TaskID AddTask(Command* command);
+
+        /*
+        Task 'after' will be started only after task 'before' is finished.
+        */
+        void AddDependency(TaskID before, TaskID after);
+
+        /*
+        Remove all tasks.
+        */
+        void Clear();
+
+        /*
+        Return count of tasks.
+        */
+        uint GetTaskCount() const { return _tasks.size(); }
+
+        /*
+        Execute all tasks respecting dependencies and wait till they are finished.
+        Waiting thread executes pending commands of the pool meanwhile.
+        Without pool tasks are executed in the calling thread.
+        Tasks discarded by a stopping pool are counted as finished without execution.
+        Graph should not be changed while running.
+        */
+        void Run(ThreadPool* pool = ThreadPool::GetDefault());
+
+    private:
+        class TaskCommand;
+
+        struct Task
+        {
+            Command* Cmd;
+            TaskCommand* Runner; // reused on each run
+            std::vector<TaskID> Continuations; // tasks that depend on this one
+            long Dependencies; // count of tasks this one depends on
+            volatile long Pending; // dependencies left in the current run
+        };
+
+        /*
+        Task is ready: start it in the pool or execute it right now.
+        */
+        void Schedule(TaskID id);
+
+        /*
+        Called after the task is executed: start continuations which are ready.
+        */
+        void Finish(TaskID id);
+
+        /*
+        Return true in case some tasks can never be started.
+        */
+        bool HasCycles() const;
+
+        std::vector<Task> _tasks;
+        ThreadPool* _pool; // pool of the current run
+        volatile long _remaining; // tasks left in the current run
+        bool _checked; // graph has no cycles
+
+        static Logger logger;
+    };
+}
\ No newline at end of file
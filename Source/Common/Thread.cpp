@@ -41,8 +41,8 @@ namespace P3D
                 }
             } else
             {
-                logger.info() << L"Thread is stopping, rejecting command.";
-                command->Release();
+                log_info(logger) << L"Thread is stopping, rejecting command.";
+                DiscardCommand(command);
             }
         }
 
@@ -84,27 +84,7 @@ namespace P3D
             Command* msg = (Command*)event.user.data1;
             if (msg == (Command*)-1)
                 return false; // stop now
-            try
-            {
-                msg->Execute(this);
-            }
-            catch (TerminateThreadException&)
-            {
-                MarkForTermination();
-            }
-            catch (Exception& exc)
-            {
-                logger.error() << L"Unhandled exception: " << exc;
-            }
-            catch (std::exception& exc)
-            {
-                logger.error() << L"Unhandled exception: " << exc.what();
-            }
-            catch (...)
-            {
-                logger.error() << L"Unknown unhandled exception.";
-            }
-            msg->Release();
+            ExecuteCommand(msg);
             return true;
         }
 
@@ -211,7 +191,7 @@ namespace P3D
 
     Thread::Thread() 
         : _name("Unnamed"), logger(L"System.Thread.Unnamed"),
-        _id(0), _startedEvent(Event::AutoReset), _stoppingNow(false),
+        _id(0), _handle(NULL), _startedEvent(Event::AutoReset), _stoppingNow(false),
         _isMainThread(false)
     {
     }
@@ -219,6 +199,8 @@ namespace P3D
     Thread::~Thread()
     {
         ASSERT(_isMainThread || (!_isMainThread && !IsRunning()));
+        if (_handle)
+            Impl::DestroyThreadHandle(_handle);
     }
 
     void Thread::Run(const char* name)
@@ -226,11 +208,16 @@ namespace P3D
         ASSERT(_isMainThread || (!_isMainThread && !IsRunning()));
 
         _name = name;
-        logger.Source = L"System.Thread." + ToUTF16(_name);
+        logger.SetSource(L"System.Thread." + ToUTF16(_name));
 
-        _queue.Reinitialize();
+        DiscardCommands(_queue);
         if (!_isMainThread)
         {
+            // handle of the previous run that stopped itself and wasn't joined
+            if (_handle)
+                Impl::DestroyThreadHandle(_handle);
+            _handle = NULL;
+
             if (!Impl::RunThread(&_handle, &_id.Unfenced(), _Run, this, NULL))
             {
                 logger.info() << L"Failed to start the thread!";
@@ -250,7 +237,7 @@ namespace P3D
         if (!_stoppingNow)
         {
             _stoppingNow = true;
-            _queue.Put((Command*)-1); // use '-1' as "stop now marker"
+            _queue.Wake();
         }
     }
 
@@ -264,7 +251,13 @@ namespace P3D
         {
             logger.info() << L"Stopping thread from another context...";
             MarkForTermination();
-            Impl::Join(_handle, INFINITE);
+            if (_handle)
+            {
+                // handle is owned by the joiner, the thread doesn't touch it on exit
+                Impl::Join(_handle, INFINITE);
+                Impl::DestroyThreadHandle(_handle);
+                _handle = NULL;
+            }
         }
     }
 
@@ -274,13 +267,16 @@ namespace P3D
             _queue.Put(command);
         else
         {
-            logger.info() << L"Thread is stopping, rejecting command.";
-            command->Release();
+            log_info(logger) << L"Thread is stopping, rejecting command.";
+            DiscardCommand(command);
         }
     }
 
     int Thread::_Thread()
     {
+        // name is shown by debuggers and profilers
+        if (!_isMainThread)
+            Impl::SetCurrentThreadName(_name.c_str());
         Initialize();
         _startedEvent.Signal();
         MessageLoop();
@@ -297,11 +293,10 @@ namespace P3D
     void Thread::Deinitialize()
     {
         _id = 0;
-        if (_handle)
-            Impl::DestroyThreadHandle(_handle);
-        _handle = 0;
         _stoppingNow = false;
         Impl::SetTLSValue(_tlsIndex, NULL);
+        CommandAllocator::ReleaseThreadCache();
+        ObjectPoolBase::ReleaseThreadCaches();
         Release();
     }
 
@@ -309,35 +304,41 @@ namespace P3D
     {
         while (true)
         {
-            Command* msg = _queue.Get();
-            if (msg == NULL && _queue.IsShuttingDown())
+            // drain all commands, sleep only when queue is empty
+            while (Command* msg = _queue.Peek())
+                ExecuteCommand(msg);
+            if (_stoppingNow)
                 break;
-            if (msg == (Command*)-1)
-            {
-                _queue.Shutdown();
-                break;
-            }
-            try
-            {
-                msg->Execute(this);
-            }
-            catch (TerminateThreadException&)
-            {
-                MarkForTermination();
-            }
-            catch (Exception& exc)
-            {
-                logger.error() << L"Unhandled exception: " << exc;
-            }
-            catch (std::exception& exc)
-            {
-                logger.error() << L"Unhandled exception: " << exc.what();
-            }
-            catch (...)
-            {
-                logger.error() << L"Unknown unhandled exception.";
-            }
-            msg->Release();
+            _queue.Wait();
+        }
+
+        // commands that came after stop was requested
+        DiscardCommands(_queue);
+    }
+
+    void Thread::ExecuteCommand(Command* msg)
+    {
+        try
+        {
+            msg->Execute(this);
+        }
+        catch (TerminateThreadException&)
+        {
+            MarkForTermination();
+        }
+        catch (Exception& exc)
+        {
+            logger.error() << L"Unhandled exception: " << exc;
+        }
+        catch (std::exception& exc)
+        {
+            logger.error() << L"Unhandled exception: " << exc.what();
+        }
+        catch (...)
+        {
+            logger.error() << L"Unknown unhandled exception.";
         }
+        msg->SignalCompletion(true);
+        msg->Release();
     }
 }
\ No newline at end of file
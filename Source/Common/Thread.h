@@ -4,7 +4,7 @@
 #include "Synchronization.h"
 #include "Logger.h"
 #include "Command.h"
-#include "Queue.h"
+#include "MPSCQueue.h"
 #include "Atomic.h"
 #include "ObjectWithTags.h"
 #include "Singleton.h"
@@ -12,6 +12,8 @@
 
 #if defined(P3D_WINDOWS)
 #include "Windows\Thread.h"
+#elif defined(P3D_POSIX)
+#include "Posix/Thread.h"
 #endif
 
 namespace P3D
@@ -60,6 +62,15 @@ namespace P3D
         */
         ThreadID GetThreadID() const { return (ThreadID)_id; }
 
+        /*
+        Restrict the thread to the processors with bits set in the mask.
+        Main thread can be restricted from itself only.
+        */
+        bool SetAffinity(uint64 mask)
+        {
+            return IsRunning() && Impl::SetAffinity(_handle, mask);
+        }
+
         /*
         Name of this thread as passed in constructor.
         */
@@ -106,12 +117,33 @@ namespace P3D
             return _mainThread;
         }
 
+        /*
+        Give the rest of time slice to other threads.
+        */
+        static void YieldExecution()
+        {
+            Impl::YieldExecution();
+        }
+
+        /*
+        Count of processors in the system.
+        */
+        static uint GetProcessorCount()
+        {
+            return Impl::GetProcessorCount();
+        }
+
     protected:
         virtual void Initialize();
         virtual void Deinitialize();
         virtual void MessageLoop();
         virtual void MarkForTermination();
 
+        /*
+        Execute the command handling exceptions and release it.
+        */
+        void ExecuteCommand(Command* command);
+
         Fenced<bool> _stoppingNow;
 
     private:
@@ -128,7 +160,7 @@ namespace P3D
         Impl::ThreadHandle _handle;
         std::string _name;
         Lock _lock;
-        Queue<Command> _queue;
+        MPSCQueue<Command> _queue;
         Event _startedEvent;
         const bool _isMainThread;
         
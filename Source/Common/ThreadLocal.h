@@ -2,6 +2,8 @@
 
 #if defined(P3D_WINDOWS)
 #include "Windows/Thread.h"
+#elif defined(P3D_POSIX)
+#include "Posix/Thread.h"
 #endif
 
 namespace P3D
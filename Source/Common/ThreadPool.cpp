@@ -0,0 +1,306 @@
+#include "Includes.h"
+#include "ThreadPool.h"
+#include "Config.h"
+
+namespace P3D
+{
+    /*
+    Worker thread of the pool.
+    */
+    class ThreadPool::Worker :
+        public Thread
+    {
+    public:
+        Worker(ThreadPool* pool, uint index)
+            : _pool(pool), _index(index), _wakeEvent(Event::AutoReset), _sleeping(0)
+        { }
+
+        /*
+        Commands invoked directly into worker go to the pool.
+        */
+        override void Invoke(Command* command)
+        {
+            _pool->Invoke(command);
+        }
+
+        /*
+        Wake up the worker if it sleeps. Return true in case it was sleeping.
+        */
+        bool WakeUp()
+        {
+            if (AtomicCAS(&_sleeping, 0, 1) != 1) return false;
+            _wakeEvent.Signal();
+            return true;
+        }
+
+        WorkStealingDeque<Command> Deque;
+
+    protected:
+        override void Initialize()
+        {
+            Thread::Initialize();
+            _currentWorker.Set(this);
+        }
+
+        override void Deinitialize()
+        {
+            while (Command* command = Deque.Pop())
+                DiscardCommand(command);
+            _currentWorker.Set(NULL);
+            Thread::Deinitialize();
+        }
+
+        override void MarkForTermination()
+        {
+            Thread::MarkForTermination();
+            _wakeEvent.Signal();
+        }
+
+        override void MessageLoop()
+        {
+            while (!_stoppingNow)
+            {
+                Command* command = _pool->TakeCommand(this);
+                if (command)
+                {
+                    ExecuteCommand(command);
+                    continue;
+                }
+
+                // announce we are going to sleep and look for work once more,
+                // producers check sleepers after publishing commands so nothing is missed
+                AtomicExchange(&_sleeping, 1);
+                AtomicIncrement(&_pool->_sleepers);
+                command = _pool->TakeCommand(this);
+                if (command == NULL && !_stoppingNow)
+                    _wakeEvent.Wait();
+                AtomicExchange(&_sleeping, 0);
+                AtomicDecrement(&_pool->_sleepers);
+
+                if (command)
+                    ExecuteCommand(command);
+            }
+        }
+
+    private:
+        friend class ThreadPool;
+
+        ThreadPool* _pool;
+        uint _index;
+        Event _wakeEvent;
+        volatile long _sleeping;
+    };
+
+    ThreadLocal<ThreadPool::Worker> ThreadPool::_currentWorker;
+    ThreadPool* ThreadPool::_default = NULL;
+    Logger ThreadPool::logger(L"System.ThreadPool");
+
+    ThreadPool::ThreadPool()
+        : _injectionLock("ThreadPool.Injection"), _sleepers(0), _stopping(false)
+    {
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        ASSERT(_workers.empty());
+    }
+
+    void ThreadPool::SetDefault(ThreadPool* pool)
+    {
+        _default = pool;
+        SetSpecialContext(CONTEXT_THREAD_POOL, pool);
+    }
+
+    void ThreadPool::Start(uint threads)
+    {
+        ASSERT(_workers.empty());
+
+        uint processors = Thread::GetProcessorCount();
+        if (threads == 0)
+            threads = Config::GetInstance().ReadInt("ThreadPool", "threads", 0);
+        if (threads == 0)
+            threads = processors > 1 ? processors - 1 : 1;
+        bool pin = Config::GetInstance().ReadBool("ThreadPool", "pinThreads", false);
+
+        _stopping = false;
+        _workers.resize(threads);
+        for (uint i = 0; i < threads; i++)
+            _workers[i] = new Worker(this, i);
+
+        // start after all workers are created since they steal from each other
+        for (uint i = 0; i < threads; i++)
+        {
+            std::ostringstream name;
+            name << "Pool" << i;
+            _workers[i]->Run(name.str().c_str());
+
+            // processor 0 is left for the main thread
+            if (pin && processors <= 64)
+                _workers[i]->SetAffinity(uint64(1) << ((i + 1) % processors));
+        }
+        logger.info() << L"Started " << threads << L" worker threads";
+    }
+
+    void ThreadPool::Stop()
+    {
+        _stopping = true;
+        for (uint i = 0; i < _workers.size(); i++)
+            _workers[i]->Join();
+        for (uint i = 0; i < _workers.size(); i++)
+            _workers[i]->Release();
+        _workers.clear();
+
+        auto_lock(_injectionLock)
+        {
+            DiscardCommands(_injectionQueue);
+        }
+    }
+
+    void ThreadPool::Invoke(Command* command)
+    {
+        if (_stopping.Unfenced())
+        {
+            log_info(logger) << L"Thread pool is stopping, rejecting command.";
+            DiscardCommand(command);
+            return;
+        }
+
+        Worker* worker = _currentWorker.Get();
+        if (worker && worker->_pool == this)
+            worker->Deque.Push(command);
+        else
+            _injectionQueue.Put(command);
+
+        ProcessorMemoryFence();
+        if (_sleepers > 0)
+            WakeWorker();
+    }
+
+    void ThreadPool::WakeWorker()
+    {
+        for (uint i = 0; i < _workers.size(); i++)
+        {
+            if (_workers[i]->WakeUp())
+                return;
+        }
+    }
+
+    Command* ThreadPool::TakeCommand(Worker* worker)
+    {
+        Command* command = NULL;
+        if (worker)
+        {
+            command = worker->Deque.Pop();
+            if (command) return command;
+        }
+
+        if (!_injectionQueue.IsEmpty())
+        {
+            auto_lock(_injectionLock)
+            {
+                command = _injectionQueue.Peek();
+            }
+            if (command) return command;
+        }
+
+        // steal starting from the next worker so thieves don't crowd the first one
+        uint count = _workers.size();
+        uint start = worker ? worker->_index + 1 : 0;
+        for (uint i = 0; i < count; i++)
+        {
+            Worker* victim = _workers[(start + i) % count];
+            if (victim == worker) continue;
+            command = victim->Deque.Steal();
+            if (command) return command;
+        }
+        return NULL;
+    }
+
+    bool ThreadPool::ExecutePendingCommand()
+    {
+        Worker* worker = _currentWorker.Get();
+        if (worker && worker->_pool != this) worker = NULL;
+
+        Command* command = TakeCommand(worker);
+        if (!command) return false;
+
+        try
+        {
+            command->Execute(this);
+        }
+        catch (Exception& exc)
+        {
+            logger.error() << L"Unhandled exception: " << exc;
+        }
+        catch (std::exception& exc)
+        {
+            logger.error() << L"Unhandled exception: " << exc.what();
+        }
+        catch (...)
+        {
+            logger.error() << L"Unknown unhandled exception.";
+        }
+        command->SignalCompletion(true);
+        command->Release();
+        return true;
+    }
+
+    /*
+    Executes command of the group and marks it finished.
+    Finishing in destructor counts discarded commands too, so Wait doesn't hang on stop.
+    */
+    class TaskGroup::TaskCommand :
+        public Command
+    {
+    public:
+        TaskCommand(Command* command, TaskGroup* group) : _command(command), _group(group)
+        { }
+
+        virtual ~TaskCommand()
+        {
+            _command->Release();
+            AtomicDecrement(&_group->_pending);
+        }
+
+        override void Execute(ExecutionContext* context)
+        {
+            _command->Execute(context);
+        }
+
+    private:
+        Command* _command;
+        TaskGroup* _group;
+    };
+
+    TaskGroup::TaskGroup(ThreadPool* pool)
+        : _pool(pool), _pending(0)
+    {
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+        Wait();
+    }
+
+    void TaskGroup::Run(Command* command)
+    {
+        if (_pool == NULL)
+        {
+            command->Execute(CONTEXT_CALL_NOW);
+            command->Release();
+            return;
+        }
+
+        AtomicIncrement(&_pending);
+        _pool->Invoke(new TaskCommand(command, this));
+    }
+
+    void TaskGroup::Wait()
+    {
+        while (_pending > 0)
+        {
+            if (!_pool->ExecutePendingCommand())
+                Thread::YieldExecution();
+        }
+    }
+}
\ No newline at end of file
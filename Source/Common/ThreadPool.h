@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Thread.h"
+#include "ThreadLocal.h"
+#include "WorkStealingDeque.h"
+#include "LockProfiler.h"
+
+namespace P3D
+{
+    /*
+    Work stealing thread pool.
+    Each worker has its own deque: commands invoked from a worker go to its deque,
+    other commands go to the global injection queue. Idle workers take commands
+    from their deque, then from the injection queue and then steal from other workers.
+    Default pool is available as CONTEXT_THREAD_POOL.
+    */
+    class ThreadPool :
+        public Object,
+        public ExecutionContext
+    {
+    public:
+        ThreadPool();
+
+        /*
+        Start worker threads.
+        0 means 'threads' attribute of 'ThreadPool' config section
+        or count of processors minus one (the thread that starts the pool also does work).
+        */
+        void Start(uint threads = 0);
+
+        /*
+        Stop all workers. Commands not executed yet are discarded (see Command::Discard).
+        */
+        void Stop();
+
+        /*
+        Return count of worker threads.
+        */
+        uint GetThreadCount() const { return _workers.size(); }
+
+        // From ExecutionContext
+
+        /*
+        Puts command to the deque of the current worker or into injection queue.
+        */
+        override void Invoke(Command* command);
+
+        /*
+        Execute one pending command in the calling thread.
+        Used to help the pool while waiting for the results.
+        Return false in case there was nothing to execute.
+        */
+        bool ExecutePendingCommand();
+
+        /*
+        Return default pool. NULL if it is not set.
+        */
+        static ThreadPool* GetDefault() { return _default; }
+
+        /*
+        Set default pool and register it as CONTEXT_THREAD_POOL.
+        */
+        static void SetDefault(ThreadPool* pool);
+
+    protected:
+        virtual ~ThreadPool();
+
+    private:
+        class Worker;
+        friend class Worker;
+
+        /*
+        Find command to execute: own deque, injection queue, other workers.
+        */
+        Command* TakeCommand(Worker* worker);
+
+        /*
+        Wake up one sleeping worker.
+        */
+        void WakeWorker();
+
+        std::vector<Worker*> _workers;
+        MPSCQueue<Command> _injectionQueue;
+        ProfiledLock<Lock> _injectionLock; // serializes consumers of the injection queue
+        volatile long _sleepers; // count of workers that are going to sleep
+        Fenced<bool> _stopping;
+
+        static ThreadLocal<Worker> _currentWorker;
+        static ThreadPool* _default;
+        static Logger logger;
+    };
+
+    /*
+    Group of commands executed by the pool that can be waited for (fork/join).
+    Can be used from the pool workers too: waiting thread executes pending commands meanwhile.
+    In case there is no pool commands are executed right in Run.
+    */
+    class TaskGroup
+    {
+    public:
+        TaskGroup(ThreadPool* pool = ThreadPool::GetDefault());
+        ~TaskGroup();
+
+        /*
+        Invoke command in the pool. Takes ownership of the command.
+        */
+        void Run(Command* command);
+
+        /*
+        Wait till all commands of the group are finished.
+        */
+        void Wait();
+
+    private:
+        class TaskCommand;
+
+        ThreadPool* _pool;
+        volatile long _pending;
+    };
+
+    namespace Internal
+    {
+        template<class Func>
+        class ParallelForCommand :
+            public Command
+        {
+        public:
+            ParallelForCommand(int begin, int end, int grain, const Func& func, TaskGroup* group)
+                : _begin(begin), _end(end), _grain(grain), _func(func), _group(group)
+            { }
+
+            override void Execute(ExecutionContext* context)
+            {
+                // split range leaving the first half to ourselves, the rest can be stolen
+                while (_end - _begin > _grain)
+                {
+                    int middle = _begin + (_end - _begin) / 2;
+                    _group->Run(new ParallelForCommand(middle, _end, _grain, _func, _group));
+                    _end = middle;
+                }
+                _func(_begin, _end);
+            }
+
+        private:
+            int _begin;
+            int _end;
+            int _grain;
+            Func _func;
+            TaskGroup* _group;
+        };
+    }
+
+    /*
+    Call func(begin, end) for subranges of [begin, end) in parallel.
+    Subranges are not longer than grain. Returns when all calls are finished.
+    */
+    template<class Func>
+    void ParallelFor(int begin, int end, int grain, Func func, ThreadPool* pool = ThreadPool::GetDefault())
+    {
+        if (end <= begin) return;
+        if (grain < 1) grain = 1;
+        if (end - begin <= grain || pool == NULL)
+        {
+            func(begin, end);
+            return;
+        }
+
+        TaskGroup group(pool);
+        group.Run(new Internal::ParallelForCommand<Func>(begin, end, grain, func, &group));
+        group.Wait();
+    }
+}
\ No newline at end of file
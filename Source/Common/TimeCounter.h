@@ -7,10 +7,19 @@ namespace P3D
     */
     class TimeCounter
     {
-        static uint64 GetTickCount();
     public:
         TimeCounter();
 
+        /*
+        Return current value of the monotonic high precision counter.
+        */
+        static uint64 GetTickCount();
+
+        /*
+        Return frequency of the counter.
+        */
+        static uint64 GetTicksPerSecond();
+
         /*
         Reset time counting.
         */
@@ -31,6 +40,18 @@ namespace P3D
             return _lastTickTime;
         }
 
+        /*
+        Advance counter by given time (msecs) instead of measuring it.
+        Used to drive simulation with recorded ticks.
+        */
+        float Tick(float time)
+        {
+            _lastTickTime = time;
+            _lastTick += uint64(double(time) * _ticksPerSec / 1000.0);
+            _ticks++;
+            return _lastTickTime;
+        }
+
         double GetTotalTime() const { return double(((_lastTick - _startTick)*1000.0f)/_ticksPerSec); }
         float GetLastTick() const { return _lastTickTime; }
 
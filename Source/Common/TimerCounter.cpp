@@ -1,7 +1,7 @@
 #include "Includes.h"
 #include "TimeCounter.h"
 
-#if !defined(P3D_WINDOWS)
+#if !defined(P3D_WINDOWS) && !defined(P3D_POSIX)
 #error TODO: implement for other platforms
 #endif
 
@@ -9,14 +9,35 @@ namespace P3D
 {
     TimeCounter::TimeCounter()
     {
-        QueryPerformanceFrequency((LARGE_INTEGER*)&_ticksPerSec);
+        _ticksPerSec = GetTicksPerSecond();
         Reset();
     }
 
+#if defined(P3D_WINDOWS)
+    uint64 TimeCounter::GetTicksPerSecond()
+    {
+        uint64 res;
+        QueryPerformanceFrequency((LARGE_INTEGER*)&res);
+        return res;
+    }
+
     uint64 TimeCounter::GetTickCount()
     {
         uint64 res;
         QueryPerformanceCounter((LARGE_INTEGER*)&res);
         return res;
     }
+#else
+    uint64 TimeCounter::GetTicksPerSecond()
+    {
+        return 1000000000; // nanoseconds
+    }
+
+    uint64 TimeCounter::GetTickCount()
+    {
+        struct timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return uint64(time.tv_sec) * 1000000000 + time.tv_nsec;
+    }
+#endif
 }
\ No newline at end of file
@@ -28,6 +28,22 @@ namespace P3D
         return InterlockedCompareExchange(var, swap, compare);
     }
 
+    /*
+    Atomically set's *var = newValue and return previous value of var.
+    */
+    inline void* AtomicExchangePointer(void* volatile* var, void* newValue)
+    {
+        return InterlockedExchangePointer(var, newValue);
+    }
+
+    /*
+    Pointer version of AtomicCAS.
+    */
+    inline void* AtomicCASPointer(void* volatile* var, void* swap, void* compare)
+    {
+        return InterlockedCompareExchangePointer(var, swap, compare);
+    }
+
     inline int64 AtomicCAS64(int64 volatile* var, int64 swap, int64 compare)
     {
         return InterlockedCompareExchange64(var, swap, compare);
@@ -55,4 +71,14 @@ namespace P3D
     inline void MemoryFence() { _ReadWriteBarrier(); }
     inline void ReadMemoryBarrier() { _ReadBarrier(); }
     inline void WriteMemoryBarrier() { _WriteBarrier(); }
+
+    /*
+    Full processor memory fence: no loads or stores are reordered across it.
+    */
+    inline void ProcessorMemoryFence() { MemoryBarrier(); }
+
+    /*
+    Hint to the processor that the thread is spinning.
+    */
+    inline void SpinPause() { YieldProcessor(); }
 }
\ No newline at end of file
@@ -43,6 +43,38 @@ namespace P3D
             {
                 return WaitForSingleObject(handle, timeout) != WAIT_TIMEOUT;
             }
+            static void YieldExecution()
+            {
+                SwitchToThread();
+            }
+            static uint GetProcessorCount()
+            {
+                SYSTEM_INFO info;
+                GetSystemInfo(&info);
+                return info.dwNumberOfProcessors;
+            }
+            static bool SetAffinity(ThreadHandle handle, uint64 mask)
+            {
+                if (handle == NULL) handle = GetCurrentThread();
+                return SetThreadAffinityMask(handle, (DWORD_PTR)mask) != 0;
+            }
+            static void SetCurrentThreadName(const char* name)
+            {
+                // name is shown by the debugger, see "How to: Set a Thread Name in Native Code"
+                struct
+                {
+                    DWORD Type;
+                    LPCSTR Name;
+                    DWORD ThreadID;
+                    DWORD Flags;
+                } info = { 0x1000, name, (DWORD)-1, 0 };
+                __try
+                {
+                    RaiseException(0x406D1388, 0, sizeof(info) / sizeof(ULONG_PTR), (ULONG_PTR*)&info);
+                }
+                __except (EXCEPTION_EXECUTE_HANDLER)
+                { }
+            }
             static TLSIndex AllocTLSIndex()
             {
                 DWORD index = TlsAlloc();
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Atomic.h"
+
+namespace P3D
+{
+    /*
+    Chase-Lev work stealing deque of pointers to T.
+    Owner thread pushes and pops at the bottom (LIFO),
+    other threads steal from the top (FIFO) without locks.
+    Grows when full, old arrays are kept till destruction since thieves may still read them.
+    */
+    template<class T>
+    class WorkStealingDeque
+    {
+    public:
+        /*
+        Capacity should be power of two.
+        */
+        WorkStealingDeque(long capacity = 256) : _top(0), _bottom(0)
+        {
+            ASSERT((capacity & (capacity - 1)) == 0);
+            _array = new Array(capacity);
+        }
+
+        ~WorkStealingDeque()
+        {
+            delete _array;
+            for (uint i = 0; i < _retired.size(); i++)
+                delete _retired[i];
+        }
+
+        // Owner thread methods
+
+        /*
+        Put item at the bottom.
+        */
+        void Push(T* item)
+        {
+            long b = _bottom;
+            long t = _top;
+            Array* a = _array;
+            if (b - t >= a->Size)
+                a = Grow(a, b, t);
+            a->Put(b, item);
+            WriteMemoryBarrier();
+            _bottom = b + 1;
+        }
+
+        /*
+        Take item from the bottom. Return NULL if deque is empty.
+        */
+        T* Pop()
+        {
+            long b = _bottom - 1;
+            Array* a = _array;
+            AtomicExchange(&_bottom, b); // full fence: thieves should see new bottom before we read top
+            long t = _top;
+            if (t > b)
+            {
+                _bottom = b + 1;
+                return NULL;
+            }
+
+            T* item = a->Get(b);
+            if (t == b)
+            {
+                // the last item, race with thieves for it
+                if (AtomicCAS(&_top, t + 1, t) != t)
+                    item = NULL;
+                _bottom = b + 1;
+            }
+            return item;
+        }
+
+        // Any thread methods
+
+        /*
+        Take item from the top. Return NULL if deque is empty or other thread took the item first.
+        */
+        T* Steal()
+        {
+            long t = _top;
+            ReadMemoryBarrier();
+            long b = _bottom;
+            if (t >= b) return NULL;
+
+            Array* a = _array;
+            T* item = a->Get(t);
+            if (AtomicCAS(&_top, t + 1, t) != t)
+                return NULL;
+            return item;
+        }
+
+        /*
+        Return true if deque seems to be empty.
+        */
+        bool IsEmpty() const
+        {
+            return _bottom <= _top;
+        }
+
+    private:
+        struct Array
+        {
+            long Size;
+            T** Items;
+
+            Array(long size) : Size(size)
+            {
+                Items = new T*[size];
+            }
+
+            ~Array()
+            {
+                delete[] Items;
+            }
+
+            T* Get(long index) const { return Items[index & (Size - 1)]; }
+            void Put(long index, T* item) { Items[index & (Size - 1)] = item; }
+        };
+
+        Array* Grow(Array* a, long bottom, long top)
+        {
+            Array* grown = new Array(a->Size * 2);
+            for (long i = top; i < bottom; i++)
+                grown->Put(i, a->Get(i));
+            _retired.push_back(a);
+            WriteMemoryBarrier();
+            _array = grown;
+            return grown;
+        }
+
+        volatile long _top;
+        volatile long _bottom;
+        Array* volatile _array;
+        std::vector<Array*> _retired; // accessed by owner only
+    };
+}
\ No newline at end of file
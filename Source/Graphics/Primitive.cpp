@@ -32,12 +32,12 @@ namespace P3D
 
             switch (_type)
             {
-            case PRIMITIVE_TRIANGLES: g_PolygonCounter += _count/3; break;
-            case PRIMITIVE_TRIANGLE_STRIP: g_PolygonCounter += (_count - 2); break;
-            case PRIMITIVE_TRIANGLE_FAN: g_PolygonCounter += (_count - 2); break;
-            case PRIMITIVE_QUADS: g_PolygonCounter += _count/4; break;
-            case PRIMITIVE_QUAD_STRIP: g_PolygonCounter += 1 + (_count - 2)/2; break;
-            case PRIMITIVE_POLYGON: g_PolygonCounter++; break;
+            case PRIMITIVE_TRIANGLES: g_PolygonCounter.Add(_count/3); break;
+            case PRIMITIVE_TRIANGLE_STRIP: g_PolygonCounter.Add(_count - 2); break;
+            case PRIMITIVE_TRIANGLE_FAN: g_PolygonCounter.Add(_count - 2); break;
+            case PRIMITIVE_QUADS: g_PolygonCounter.Add(_count/4); break;
+            case PRIMITIVE_QUAD_STRIP: g_PolygonCounter.Add(1 + (_count - 2)/2); break;
+            case PRIMITIVE_POLYGON: g_PolygonCounter.Increment(); break;
             }
         }
 
@@ -69,12 +69,12 @@ namespace P3D
 
             switch (type)
             {
-            case PRIMITIVE_TRIANGLES: g_PolygonCounter += count/3; break;
-            case PRIMITIVE_TRIANGLE_STRIP: g_PolygonCounter += (count - 2); break;
-            case PRIMITIVE_TRIANGLE_FAN: g_PolygonCounter += (count - 2); break;
-            case PRIMITIVE_QUADS: g_PolygonCounter += count/4; break;
-            case PRIMITIVE_QUAD_STRIP: g_PolygonCounter += 1 + (count - 2)/2; break;
-            case PRIMITIVE_POLYGON: g_PolygonCounter++; break;
+            case PRIMITIVE_TRIANGLES: g_PolygonCounter.Add(count/3); break;
+            case PRIMITIVE_TRIANGLE_STRIP: g_PolygonCounter.Add(count - 2); break;
+            case PRIMITIVE_TRIANGLE_FAN: g_PolygonCounter.Add(count - 2); break;
+            case PRIMITIVE_QUADS: g_PolygonCounter.Add(count/4); break;
+            case PRIMITIVE_QUAD_STRIP: g_PolygonCounter.Add(1 + (count - 2)/2); break;
+            case PRIMITIVE_POLYGON: g_PolygonCounter.Increment(); break;
             }
         }
     }
@@ -13,7 +13,7 @@ namespace P3D
         /*
         Single shader compilation unit.
         */
-        class Shader : public Object
+        class Shader : public LocalObject
         {
             friend class ShaderProgram;
 
@@ -50,7 +50,7 @@ namespace P3D
         /*
         Several Shader objects linked together.
         */
-        class ShaderProgram : public Object
+        class ShaderProgram : public LocalObject
         {
         public:
             ShaderProgram();
@@ -22,7 +22,7 @@ namespace P3D
         Texture object. Incapsulates texture data.
         */
         class Texture : 
-            public Object
+            public LocalObject
         {
             friend class TextureManager;
 
@@ -26,7 +26,7 @@ namespace P3D
             extern void DeinitArrays(const VertexDescription& vd);
 
             template<int target>
-            class OpenGLBuffer : public Object
+            class OpenGLBuffer : public LocalObject
             {
             public:
                 OpenGLBuffer()
@@ -0,0 +1,13 @@
+#pragma once
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "Common/DataTypes.h"
+#include "Common/BinaryLogFormat.h"
\ No newline at end of file
@@ -0,0 +1,173 @@
+// LogDecoder.cpp : Converts binary log written by BinaryFileAppender to text.
+//
+
+#include "Includes.h"
+
+using namespace P3D;
+using namespace P3D::BinaryLog;
+
+typedef std::map<uint32, String> TextTable;
+
+const wchar* GetLevelName(int level)
+{
+    switch (level)
+    {
+        case 1: return L"[TRACE] ";
+        case 2: return L"[DEBUG] ";
+        case 3: return L"[INFO]  ";
+        case 4: return L"[WARN]  ";
+        case 5: return L"[ERROR] ";
+    }
+    return L"";
+}
+
+/*
+Read text of definition record. Return false if the record is truncated.
+*/
+bool ReadDefinition(const byte*& pos, const byte* end, TextTable& table)
+{
+    if (end - pos < (int)sizeof(SourceRecord)) return false;
+    const SourceRecord* record = (const SourceRecord*)pos;
+    pos += sizeof(SourceRecord);
+
+    uint size = record->Length * sizeof(wchar);
+    if ((uint)(end - pos) < size) return false;
+    table[record->ID].assign((const wchar*)pos, record->Length);
+    pos += size;
+    return true;
+}
+
+/*
+Read message record and print it. Return false if the record is truncated.
+*/
+bool ReadMessage(const byte*& pos, const byte* end, const FileHeader& header,
+                 const TextTable& sources, const TextTable& formats, FILE* out)
+{
+    if (end - pos < (int)sizeof(MessageRecord)) return false;
+    const MessageRecord* record = (const MessageRecord*)pos;
+    pos += sizeof(MessageRecord);
+
+    std::vector<uint64> args(record->ArgCount);
+    for (uint i = 0; i < record->ArgCount; i++)
+    {
+        uint size = ReadVarint(pos, end - pos, &args[i]);
+        if (size == 0) return false;
+        pos += size;
+    }
+
+    // restore wall clock time from the counter
+    int64 ticks = int64(record->Timestamp - header.StartTicks);
+    double seconds = double(ticks) / double(header.TicksPerSecond);
+    __time64_t time = header.StartTime + __time64_t(floor(seconds));
+    int msecs = int((seconds - floor(seconds)) * 1000);
+    struct tm ttt;
+    _localtime64_s(&ttt, &time);
+
+    String message;
+    TextTable::const_iterator format = formats.find(record->FormatID);
+    if (format != formats.end())
+    {
+        uint arg = 0;
+        const String& text = format->second;
+        for (uint i = 0; i < text.size(); i++)
+        {
+            if (text[i] == ArgPlaceholder && arg < args.size())
+            {
+                wchar buf[32];
+                swprintf_s(buf, L"%I64u", args[arg++]);
+                message += buf;
+            } else
+                message += text[i];
+        }
+    } else
+        message = L"<unknown format>";
+
+    TextTable::const_iterator source = sources.find(record->SourceID);
+    fwprintf(out, L"%s<%u> [%02i:%02i:%02i-%03i] {%s} : %s\n",
+        GetLevelName(record->Level), record->ThreadID,
+        ttt.tm_hour, ttt.tm_min, ttt.tm_sec, msecs,
+        source != sources.end() ? source->second.c_str() : L"?",
+        message.c_str());
+    return true;
+}
+
+int wmain(int argc, wchar** argv)
+{
+    if (argc < 2)
+    {
+        fwprintf(stderr, L"Usage: LogDecoder <Log.bin> [<Log.txt>]\n");
+        return 1;
+    }
+
+    FILE* in = _wfopen(argv[1], L"rb");
+    if (in == NULL)
+    {
+        fwprintf(stderr, L"Can't open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<byte> data;
+    byte buf[64 * 1024];
+    while (size_t read = fread(buf, 1, sizeof(buf), in))
+        data.insert(data.end(), buf, buf + read);
+    fclose(in);
+
+    FILE* out = stdout;
+    if (argc > 2)
+    {
+        out = _wfopen(argv[2], L"wt");
+        if (out == NULL)
+        {
+            fwprintf(stderr, L"Can't create %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    if (data.size() < sizeof(FileHeader))
+    {
+        fwprintf(stderr, L"File is too small\n");
+        return 1;
+    }
+    const FileHeader& header = *(const FileHeader*)&data[0];
+    if (header.Magic != Magic || header.Version != Version)
+    {
+        fwprintf(stderr, L"Unknown file format\n");
+        return 1;
+    }
+
+    TextTable sources;
+    TextTable formats;
+    uint messages = 0;
+    const byte* pos = &data[0] + sizeof(FileHeader);
+    const byte* end = &data[0] + data.size();
+    bool truncated = false;
+    while (pos < end && !truncated)
+    {
+        byte type = *pos++;
+        switch (type)
+        {
+            case Record_End:
+                pos = end;
+                break;
+            case Record_Source:
+                truncated = !ReadDefinition(pos, end, sources);
+                break;
+            case Record_Format:
+                truncated = !ReadDefinition(pos, end, formats);
+                break;
+            case Record_Message:
+                truncated = !ReadMessage(pos, end, header, sources, formats, out);
+                if (!truncated) messages++;
+                break;
+            default:
+                fwprintf(stderr, L"Unknown record type %i, the file is corrupted\n", (int)type);
+                truncated = true;
+        }
+    }
+    if (truncated)
+        fwprintf(stderr, L"The last record is truncated\n");
+
+    if (out != stdout)
+        fclose(out);
+    fwprintf(stderr, L"%u messages decoded\n", messages);
+    return 0;
+}
\ No newline at end of file
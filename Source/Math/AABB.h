@@ -54,6 +54,24 @@ namespace P3D
             return true;
         }
 
+        /*
+        Is other box inside this one not touching its faces?
+        */
+        mathinline bool IsStrictlyInside(const AABB& box) const
+        {
+            return box.Min().x > Min().x && box.Max().x < Max().x &&
+                box.Min().y > Min().y && box.Max().y < Max().y &&
+                box.Min().z > Min().z && box.Max().z < Max().z;
+        }
+
+        /*
+        Was box set impossible and never enlarged?
+        */
+        mathinline bool IsImpossible() const
+        {
+            return Min().x > Max().x;
+        }
+
         mathinline void SetZero()
         {
             Min().SetZero();
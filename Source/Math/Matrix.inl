@@ -72,7 +72,7 @@ namespace P3D
 
     mathinline bool Matrix::Invert(Scalar epsilon)
     {
-        IncCounter(g_MatrixInverse);
+        g_MatrixInverse.Increment();
 
         Vector r0 = GetColumn(1) ^ GetColumn(2);
         Vector r1 = GetColumn(2) ^ GetColumn(0);
@@ -115,7 +115,7 @@ namespace P3D
 
     mathinline void Matrix::operator*=(const Matrix& a)
     {
-        IncCounter(g_MatrixMultiply);
+        g_MatrixMultiply.Increment();
 
         Matrix& Ma = *this;
         for (int i = 0; i < 3; i++)
@@ -130,7 +130,7 @@ namespace P3D
 
     mathinline void Matrix::SetMultiply(const Matrix& a, const Matrix& b)
     {
-        IncCounter(g_MatrixMultiply);
+        g_MatrixMultiply.Increment();
 
         for (int i = 0; i < 3; i++)
         {
@@ -146,7 +146,7 @@ namespace P3D
     {
         // See http://en.wikipedia.org/wiki/Rotation_matrix#Quaternion
 
-        IncCounter(g_QuaternionToMatrixConversion);
+        g_QuaternionToMatrixConversion.Increment();
 
         Scalar wx, wy, wz, xx, yy, yz, xy, xz, zz, x2, y2, z2;
         x2 = q.x + q.x;
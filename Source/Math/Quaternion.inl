@@ -122,7 +122,7 @@ namespace P3D
 
     mathinline Quaternion operator*(const Quaternion& a, const Quaternion& b)
     {
-        IncCounter(g_QuaternionMultiply);
+        g_QuaternionMultiply.Increment();
 
         // See http://en.wikipedia.org/wiki/Quaternion#Quaternion_products
         return Quaternion
@@ -142,7 +142,7 @@ namespace P3D
 
     mathinline void Quaternion::SetMatrix(const Matrix& m)
     {
-        IncCounter(g_MatrixToQuaternionConversion);
+        g_MatrixToQuaternionConversion.Increment();
 
         //See: http://gamedev.ru/articles/?id=30129&page=2
         float tr = m(0, 0) + m(1, 1) + m(2, 2); // trace of martix
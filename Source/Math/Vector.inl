@@ -70,7 +70,7 @@ namespace P3D
 
     mathinline void Vector::SetMultiply(const Matrix& a, const Vector& b)
     {
-        IncCounter(g_VectorMatrixTransform);
+        g_VectorMatrixTransform.Increment();
 
         Scalar nx = a(0,0)*b(0) + a(0,1)*b(1) + a(0,2)*b(2);
         Scalar ny = a(1,0)*b(0) + a(1,1)*b(1) + a(1,2)*b(2);
@@ -87,7 +87,7 @@ namespace P3D
 
     mathinline void Vector::InvTransform(const class Matrix& a)
     {
-        IncCounter(g_VectorMatrixTransform);
+        g_VectorMatrixTransform.Increment();
 
         Vector& b = *this;
 
@@ -101,7 +101,7 @@ namespace P3D
 
     mathinline void Vector::Transform(const P3D::Transform& trans)
     {
-        IncCounter(g_VectorMatrixTransform);
+        g_VectorMatrixTransform.Increment();
 
         Vector& b = *this;
         const Matrix& a = trans.Rotation;
@@ -120,7 +120,7 @@ namespace P3D
     */
     mathinline void Vector::InvTransform(const P3D::Transform& t)
     {
-        IncCounter(g_VectorMatrixTransform);
+        g_VectorMatrixTransform.Increment();
 
         const Matrix& r = t.Rotation;
         Vector& v = *this;
@@ -6,7 +6,38 @@ namespace P3D
 {
     namespace Physics
     {
-        class BulletBoxCollisionModel : 
+        /*
+        Identifies collision model by its type and shape parameters.
+        Used by BulletWorld to share models between entities.
+        Hulls and meshes are identified by CRC of their data, so the data itself
+        should be compared when keys are equal.
+        */
+        struct CollisionModelKey
+        {
+            CollisionModel::ModelType Type;
+            Scalar Params[3];
+            int32 DataHash;
+            uint DataSize;
+
+            CollisionModelKey(CollisionModel::ModelType type, Scalar p0 = 0, Scalar p1 = 0, Scalar p2 = 0)
+                : Type(type), DataHash(0), DataSize(0)
+            {
+                Params[0] = p0;
+                Params[1] = p1;
+                Params[2] = p2;
+            }
+
+            bool operator<(const CollisionModelKey& key) const
+            {
+                if (Type != key.Type) return Type < key.Type;
+                for (int i = 0; i < 3; i++)
+                    if (Params[i] != key.Params[i]) return Params[i] < key.Params[i];
+                if (DataHash != key.DataHash) return DataHash < key.DataHash;
+                return DataSize < key.DataSize;
+            }
+        };
+
+        class BulletBoxCollisionModel :
             public CollisionModel,
             public btBoxShape
         {
@@ -16,5 +47,131 @@ namespace P3D
                     btBoxShape(btVector3(sx / 2, sy / 2, sz / 2))
             { }
         };
+
+        class BulletSphereCollisionModel :
+            public CollisionModel,
+            public btSphereShape
+        {
+        public:
+            BulletSphereCollisionModel(Scalar radius)
+                : CollisionModel(CollisionModel::Sphere),
+                    btSphereShape(radius)
+            { }
+        };
+
+        class BulletCapsuleCollisionModel :
+            public CollisionModel,
+            public btCapsuleShapeZ
+        {
+        public:
+            BulletCapsuleCollisionModel(Scalar radius, Scalar height)
+                : CollisionModel(CollisionModel::Capsule),
+                    btCapsuleShapeZ(radius, height)
+            { }
+        };
+
+        class BulletConvexHullCollisionModel :
+            public CollisionModel,
+            public btConvexHullShape
+        {
+        public:
+            BulletConvexHullCollisionModel(const Vector* points, uint count)
+                : CollisionModel(CollisionModel::ConvexHull),
+                    btConvexHullShape(points->GetRealPointer(), count, sizeof(Vector))
+            { }
+
+            /*
+            Return true in case the hull is built exactly from these points.
+            */
+            bool HasPoints(const Vector* points, uint count) const
+            {
+                if ((uint)getNumPoints() != count) return false;
+                const btVector3* own = getUnscaledPoints();
+                for (uint i = 0; i < count; i++)
+                {
+                    if (own[i].x() != points[i].x || own[i].y() != points[i].y || own[i].z() != points[i].z)
+                        return false;
+                }
+                return true;
+            }
+        };
+
+        namespace Internal
+        {
+            /*
+            Owns mesh data for BulletTriangleMeshCollisionModel.
+            Separate base class so it is constructed before btBvhTriangleMeshShape.
+            */
+            struct BulletTriangleMeshData
+            {
+                std::vector<Vector> Vertices;
+                std::vector<int> Indices;
+                btTriangleIndexVertexArray MeshInterface;
+
+                BulletTriangleMeshData(const Vector* vertices, uint vertexCount, const uint* indices, uint indexCount)
+                    : Vertices(vertices, vertices + vertexCount), Indices(indices, indices + indexCount)
+                {
+                    btIndexedMesh mesh;
+                    mesh.m_numTriangles = indexCount / 3;
+                    mesh.m_triangleIndexBase = (const unsigned char*)&Indices[0];
+                    mesh.m_triangleIndexStride = 3 * sizeof(int);
+                    mesh.m_numVertices = vertexCount;
+                    mesh.m_vertexBase = (const unsigned char*)Vertices[0].GetRealPointer();
+                    mesh.m_vertexStride = sizeof(Vector);
+                    MeshInterface.addIndexedMesh(mesh);
+                }
+            };
+        }
+
+        class BulletTriangleMeshCollisionModel :
+            public CollisionModel,
+            private Internal::BulletTriangleMeshData,
+            public btBvhTriangleMeshShape
+        {
+        public:
+            BulletTriangleMeshCollisionModel(const Vector* vertices, uint vertexCount, const uint* indices, uint indexCount)
+                : CollisionModel(CollisionModel::TriangleMesh),
+                    Internal::BulletTriangleMeshData(vertices, vertexCount, indices, indexCount),
+                    btBvhTriangleMeshShape(&MeshInterface, true)
+            { }
+
+            /*
+            Return true in case the mesh is built exactly from this data.
+            */
+            bool HasData(const Vector* vertices, uint vertexCount, const uint* indices, uint indexCount) const
+            {
+                if (Vertices.size() != vertexCount || Indices.size() != indexCount) return false;
+                for (uint i = 0; i < vertexCount; i++)
+                {
+                    if (Vertices[i].x != vertices[i].x || Vertices[i].y != vertices[i].y || Vertices[i].z != vertices[i].z)
+                        return false;
+                }
+                for (uint i = 0; i < indexCount; i++)
+                    if ((uint)Indices[i] != indices[i]) return false;
+                return true;
+            }
+        };
+
+        /*
+        Return bullet shape behind collision model.
+        */
+        inline btCollisionShape* GetBulletShape(CollisionModel* cm)
+        {
+            switch (cm->GetType())
+            {
+                case CollisionModel::Box:
+                    return static_cast<BulletBoxCollisionModel*>(cm);
+                case CollisionModel::Sphere:
+                    return static_cast<BulletSphereCollisionModel*>(cm);
+                case CollisionModel::Capsule:
+                    return static_cast<BulletCapsuleCollisionModel*>(cm);
+                case CollisionModel::ConvexHull:
+                    return static_cast<BulletConvexHullCollisionModel*>(cm);
+                case CollisionModel::TriangleMesh:
+                    return static_cast<BulletTriangleMeshCollisionModel*>(cm);
+                default:
+                    return NULL;
+            }
+        }
     }
-}
\ No newline at end of file
+}
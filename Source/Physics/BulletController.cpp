@@ -12,6 +12,8 @@ namespace P3D
         {
             _body = NULL;
             _entity = entity;
+            _transformChanged = false;
+            _sleeping = false;
         }
 
         void BulletController::Bind(World::Entity* entity)
@@ -32,6 +34,8 @@ namespace P3D
         void BulletController::UpdateEntity(World::Entity* entity, const TimeCounter& time)
         {
             ASSERT(_body != NULL);
+            if (!_transformChanged) return;
+            _transformChanged = false;
             _entity->SetTransformToWorldSpace(Conv(_toWorldSpace));
         }
 
@@ -39,27 +43,36 @@ namespace P3D
         {
             ASSERT(entity->GetCollisionModel() != NULL);
             CollisionModel* cm = entity->GetCollisionModel();
-            btCollisionShape* shape = NULL;
-            switch (cm->GetType())
+            btCollisionShape* shape = GetBulletShape(cm);
+            ASSERT(shape != NULL);
+
+            Scalar mass = entity->GetMass();
+            if (cm->GetType() == CollisionModel::TriangleMesh && mass != 0)
             {
-                case CollisionModel::Box:
-                    shape = ((BulletBoxCollisionModel*)cm);
-                break;
-                default:
-                    shape = NULL;
+                logger.warn() << L"Triangle mesh can be used only by static entities, ignoring mass";
+                mass = 0;
             }
-            ASSERT(shape != NULL);
 
             btVector3 inertia(0, 0, 0);
-            shape->calculateLocalInertia(entity->GetMass(), inertia);
+            if (mass != 0)
+                shape->calculateLocalInertia(mass, inertia);
 
             btRigidBody::btRigidBodyConstructionInfo ci(
-                entity->GetMass(),  this, shape, inertia);
+                mass,  this, shape, inertia);
             _body = new btRigidBody(ci);
+            _body->setUserPointer(entity);
+            ParametersChanged(entity);
 
             ((BulletWorld*)entity->GetWorld()->GetPhysicalWorld())->GetDynamicsWorld()->addRigidBody(_body);
         }
 
+        void BulletController::ParametersChanged(World::Entity* entity)
+        {
+            ASSERT(_body != NULL);
+            _body->setCcdMotionThreshold(entity->GetCcdMotionThreshold());
+            _body->setCcdSweptSphereRadius(entity->GetCcdSweptSphereRadius());
+        }
+
         // From btMotionState
         void BulletController::getWorldTransform(btTransform& worldTrans) const
         {
@@ -69,10 +82,24 @@ namespace P3D
             _toWorldSpace = worldTrans;
         }
 
-        //Bullet only calls the update of worldtransform for active objects
+        // Bullet calls it for sleeping objects as well, so track activation here
         void BulletController::setWorldTransform(const btTransform& worldTrans)
         {
+            bool sleeping = (_body != NULL) && !_body->isActive();
+            bool wasSleeping = _sleeping;
+            if (sleeping != _sleeping)
+            {
+                _sleeping = sleeping;
+                if (sleeping)
+                    DispatchEvent(&World::EntityControllerListener::OnFallAsleep, _entity);
+                else
+                    DispatchEvent(&World::EntityControllerListener::OnWakeUp, _entity);
+            }
+            // transform of the step the body falls asleep in is the resting one, keep it
+            if (sleeping && wasSleeping) return;
+
             _toWorldSpace = worldTrans;
+            _transformChanged = true;
         }
     }
 }
\ No newline at end of file
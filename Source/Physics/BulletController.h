@@ -34,17 +34,30 @@ namespace P3D
             */
             override void Prepare(World::Entity* entity);
 
+            /*
+            Apply changed continuous collision parameters to the body.
+            */
+            override void ParametersChanged(World::Entity* entity);
+
+            /*
+            Return true when bullet deactivated the body and its last transform
+            is already passed to the entity.
+            */
+            override bool IsSleeping(const World::Entity* entity) const { return _sleeping && !_transformChanged; }
+
         protected:
             // From btMotionState
             override void getWorldTransform(btTransform& worldTrans) const;
 
-            //Bullet only calls the update of worldtransform for active objects
+            // Bullet calls it after each step for all bodies, sleeping ones included
             override void setWorldTransform(const btTransform& worldTrans);
 
         private:
             btRigidBody* _body;
             World::Entity* _entity;
             mutable btTransform _toWorldSpace;
+            bool _transformChanged; // setWorldTransform was called since last UpdateEntity
+            bool _sleeping; // body was deactivated by bullet
         };
     }
 }
\ No newline at end of file
@@ -2,11 +2,15 @@
 #include "BulletWorld.h"
 #include "BulletController.h"
 #include "BulletMathIterop.h"
+#include "Common/Config.h"
+#include "Common/Profiler.h"
 
 namespace P3D
 {
     namespace Physics
     {
+        Logger BulletWorld::logger(L"Physics.BulletWorld");
+
         PhysicalWorld* CreatePhysicalWorld()
         {
             return new BulletWorld();
@@ -19,10 +23,18 @@ namespace P3D
             _dispatcher = NULL;
             _solver = NULL;
             _world = NULL;
+            _profileIterator = NULL;
+            _profileDump = NULL;
+            _stepNumber = 0;
         }
 
         BulletWorld::~BulletWorld()
         {
+            ReleaseCollisionModels();
+
+            SetProfileDumpFile(L"");
+            if (_profileIterator) CProfileManager::Release_Iterator(_profileIterator);
+
             delete _world;
             delete _solver;
             delete _dispatcher;
@@ -51,6 +63,105 @@ namespace P3D
                 _solver, _collisionConf);
 
             _world->setGravity(btVector3(0, 0, -9.8f));
+
+            _profileIterator = CProfileManager::Get_Iterator();
+
+            String dump = Config::GetInstance().ReadWideString("Physics", "profileDump");
+            if (!dump.empty()) SetProfileDumpFile(dump);
+        }
+
+        CollisionModel* BulletWorld::FindCollisionModel(const CollisionModelKey& key)
+        {
+            AutoLock lock(_modelsLock);
+            ModelsMap::iterator it = _models.find(key);
+            if (it == _models.end()) return NULL;
+            it->second->AddRef();
+            return it->second;
+        }
+
+        CollisionModel* BulletWorld::AddCollisionModel(const CollisionModelKey& key, CollisionModel* model)
+        {
+            AutoLock lock(_modelsLock);
+            _models.insert(std::make_pair(key, model)); // takes creation reference
+            model->AddRef();
+            return model;
+        }
+
+        void BulletWorld::ReleaseCollisionModels()
+        {
+            AutoLock lock(_modelsLock);
+            for (ModelsMap::iterator it = _models.begin(); it != _models.end(); ++it)
+                it->second->Release();
+            _models.clear();
+        }
+
+        CollisionModel* BulletWorld::CreateBoxCollisionModel(Scalar sx, Scalar sy, Scalar sz)
+        {
+            CollisionModelKey key(CollisionModel::Box, sx, sy, sz);
+            CollisionModel* model = FindCollisionModel(key);
+            if (model) return model;
+            return AddCollisionModel(key, new BulletBoxCollisionModel(sx, sy, sz));
+        }
+
+        CollisionModel* BulletWorld::CreateSphereCollisionModel(Scalar radius)
+        {
+            CollisionModelKey key(CollisionModel::Sphere, radius);
+            CollisionModel* model = FindCollisionModel(key);
+            if (model) return model;
+            return AddCollisionModel(key, new BulletSphereCollisionModel(radius));
+        }
+
+        CollisionModel* BulletWorld::CreateCapsuleCollisionModel(Scalar radius, Scalar height)
+        {
+            CollisionModelKey key(CollisionModel::Capsule, radius, height);
+            CollisionModel* model = FindCollisionModel(key);
+            if (model) return model;
+            return AddCollisionModel(key, new BulletCapsuleCollisionModel(radius, height));
+        }
+
+        CollisionModel* BulletWorld::CreateConvexHullCollisionModel(const Vector* points, uint count)
+        {
+            ASSERT(points != NULL && count > 0);
+
+            CollisionModelKey key(CollisionModel::ConvexHull);
+            key.DataHash = CRC32(points, count * sizeof(Vector));
+            key.DataSize = count;
+
+            AutoLock lock(_modelsLock);
+            std::pair<ModelsMap::iterator, ModelsMap::iterator> range = _models.equal_range(key);
+            for (ModelsMap::iterator it = range.first; it != range.second; ++it)
+            {
+                if (static_cast<BulletConvexHullCollisionModel*>(it->second)->HasPoints(points, count))
+                {
+                    it->second->AddRef();
+                    return it->second;
+                }
+            }
+            return AddCollisionModel(key, new BulletConvexHullCollisionModel(points, count));
+        }
+
+        CollisionModel* BulletWorld::CreateTriangleMeshCollisionModel(const Vector* vertices, uint vertexCount,
+            const uint* indices, uint indexCount)
+        {
+            ASSERT(vertices != NULL && vertexCount > 0);
+            ASSERT(indices != NULL && indexCount > 0 && (indexCount % 3) == 0);
+
+            CollisionModelKey key(CollisionModel::TriangleMesh);
+            key.DataHash = CRC32(vertices, vertexCount * sizeof(Vector)) ^ CRC32(indices, indexCount * sizeof(uint));
+            key.DataSize = vertexCount;
+            key.Params[0] = (Scalar)indexCount;
+
+            AutoLock lock(_modelsLock);
+            std::pair<ModelsMap::iterator, ModelsMap::iterator> range = _models.equal_range(key);
+            for (ModelsMap::iterator it = range.first; it != range.second; ++it)
+            {
+                if (static_cast<BulletTriangleMeshCollisionModel*>(it->second)->HasData(vertices, vertexCount, indices, indexCount))
+                {
+                    it->second->AddRef();
+                    return it->second;
+                }
+            }
+            return AddCollisionModel(key, new BulletTriangleMeshCollisionModel(vertices, vertexCount, indices, indexCount));
         }
 
         /*
@@ -63,13 +174,194 @@ namespace P3D
             return new BulletController(this, entity);
         }
 
+        void BulletWorld::SetContinuousCollision(World::Entity* entity, Scalar motionThreshold, Scalar sweptSphereRadius)
+        {
+            if (motionThreshold < 0 || sweptSphereRadius < 0)
+            {
+                if (!entity->GetCollisionModel())
+                {
+                    logger.warn() << L"Can't fit continuous collision parameters for entity without collision model";
+                    return;
+                }
+
+                btTransform identity;
+                identity.setIdentity();
+                btVector3 aabbMin, aabbMax;
+                GetBulletShape(entity->GetCollisionModel())->getAabb(identity, aabbMin, aabbMax);
+                btVector3 halfExtents = (aabbMax - aabbMin) * 0.5f;
+                Scalar smallest = halfExtents[halfExtents.minAxis()];
+
+                if (motionThreshold < 0) motionThreshold = smallest;
+                if (sweptSphereRadius < 0) sweptSphereRadius = smallest * 0.8f;
+            }
+            entity->SetContinuousCollision(motionThreshold, sweptSphereRadius);
+        }
+
+        namespace
+        {
+            /*
+            Closest hit skipping bodies of one entity.
+            */
+            struct ClosestNotIgnoredConvexResultCallback : 
+                public btCollisionWorld::ClosestConvexResultCallback
+            {
+                const World::Entity* Ignore;
+
+                ClosestNotIgnoredConvexResultCallback(const btVector3& from, const btVector3& to, const World::Entity* ignore)
+                    : btCollisionWorld::ClosestConvexResultCallback(from, to), Ignore(ignore)
+                { }
+
+                override bool needsCollision(btBroadphaseProxy* proxy) const
+                {
+                    if (Ignore && ((btCollisionObject*)proxy->m_clientObject)->getUserPointer() == Ignore)
+                        return false;
+                    return btCollisionWorld::ClosestConvexResultCallback::needsCollision(proxy);
+                }
+            };
+        }
+
+        void BulletWorld::ConvexSweepTest(const SweepQuery* queries, SweepResult* results, uint count)
+        {
+            for (uint i = 0; i < count; i++)
+            {
+                const SweepQuery& query = queries[i];
+                SweepResult& result = results[i];
+                result.Hit = false;
+                result.Fraction = 1;
+                result.Entity = NULL;
+
+                btCollisionShape* shape = query.Model ? GetBulletShape(query.Model) : NULL;
+                if (!shape || !shape->isConvex())
+                {
+                    logger.warn() << L"Convex sweep test needs convex collision model";
+                    continue;
+                }
+
+                btTransform from = Conv(query.From);
+                btTransform to = Conv(query.To);
+                ClosestNotIgnoredConvexResultCallback callback(from.getOrigin(), to.getOrigin(), query.Ignore);
+                _world->convexSweepTest(static_cast<btConvexShape*>(shape), from, to, callback);
+
+                if (!callback.hasHit()) continue;
+                result.Hit = true;
+                result.Fraction = callback.m_closestHitFraction;
+                result.Point = Conv(callback.m_hitPointWorld);
+                result.Normal = Conv(callback.m_hitNormalWorld);
+                result.Entity = (World::Entity*)callback.m_hitCollisionObject->getUserPointer();
+            }
+        }
+
         /*
         Make simulation step.
         */
         void BulletWorld::Update(TimeCounter& time)
         {
             if (time.GetTotalTime() <  1000) return;
-            _world->stepSimulation(time.GetLastTick() * 0.001f, 2);
+            PROFILE_SCOPE("Physics.Step");
+
+            // bullet profiler accumulates times since reset, so reset it each step
+            CProfileManager::Reset();
+            _profile.SubSteps = _world->stepSimulation(time.GetLastTick() * 0.001f, 2);
+            CollectProfile();
+            if (_profileDump) WriteProfileDump();
+            _stepNumber++;
+        }
+
+        namespace
+        {
+            inline bool NameIs(const char* name, const char* what)
+            {
+                return strcmp(name, what) == 0;
+            }
+
+            /*
+            Sum times of known BT_PROFILE sections into the phases.
+            Walks whole profile tree, iterator is left where it was.
+            */
+            void AccumulatePhases(CProfileIterator* it, PhysicsProfile& profile)
+            {
+                int children = 0;
+                for (it->First(); !it->Is_Done(); it->Next(), children++)
+                {
+                    const char* name = it->Get_Current_Name();
+                    float time = it->Get_Current_Total_Time();
+
+                    if (NameIs(name, "stepSimulation"))
+                        profile.Total += time;
+                    else if (NameIs(name, "updateAabbs") || NameIs(name, "calculateOverlappingPairs"))
+                        profile.Broadphase += time;
+                    else if (NameIs(name, "dispatchAllCollisionPairs"))
+                        profile.Narrowphase += time;
+                    else if (NameIs(name, "calculateSimulationIslands") || NameIs(name, "solveConstraints"))
+                        profile.Solver += time;
+                    else if (NameIs(name, "predictUnconstraintMotion") || NameIs(name, "integrateTransforms") 
+                        || NameIs(name, "synchronizeMotionStates"))
+                        profile.Integration += time;
+                }
+
+                for (int i = 0; i < children; i++)
+                {
+                    it->Enter_Child(i);
+                    AccumulatePhases(it, profile);
+                    it->Enter_Parent();
+                }
+            }
+
+            inline int ToMicroseconds(float ms)
+            {
+                return (int)(ms * 1000.0f);
+            }
+        }
+
+        void BulletWorld::CollectProfile()
+        {
+            _profile.Total = 0;
+            _profile.Broadphase = 0;
+            _profile.Narrowphase = 0;
+            _profile.Solver = 0;
+            _profile.Integration = 0;
+            AccumulatePhases(_profileIterator, _profile);
+
+            _profile.Pairs = _broadphase->getOverlappingPairCache()->getNumOverlappingPairs();
+
+            _profile.Contacts = 0;
+            int manifolds = _dispatcher->getNumManifolds();
+            for (int i = 0; i < manifolds; i++)
+                _profile.Contacts += _dispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+
+            g_PhysicsStepTime.Set(ToMicroseconds(_profile.Total));
+            g_PhysicsBroadphaseTime.Set(ToMicroseconds(_profile.Broadphase));
+            g_PhysicsNarrowphaseTime.Set(ToMicroseconds(_profile.Narrowphase));
+            g_PhysicsSolverTime.Set(ToMicroseconds(_profile.Solver));
+            g_PhysicsIntegrationTime.Set(ToMicroseconds(_profile.Integration));
+            g_PhysicsPairs.Set(_profile.Pairs);
+            g_PhysicsContacts.Set(_profile.Contacts);
+            g_PhysicsStepTimes.Record(ToMicroseconds(_profile.Total));
+        }
+
+        void BulletWorld::SetProfileDumpFile(const String& file)
+        {
+            if (_profileDump) 
+            {
+                fclose(_profileDump);
+                _profileDump = NULL;
+            }
+            if (file.empty()) return;
+
+            _profileDump = _wfopen(file.c_str(), L"wt");
+            if (!_profileDump)
+            {
+                logger.error() << L"Can't open physics profile dump file: " << file;
+                return;
+            }
+            fprintf(_profileDump, "Step,Total,Broadphase,Narrowphase,Solver,Integration,SubSteps,Pairs,Contacts\n");
+        }
+
+        void BulletWorld::WriteProfileDump()
+        {
+            fprintf(_profileDump, "%u,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%d,%d\n", _stepNumber, 
+                _profile.Total, _profile.Broadphase, _profile.Narrowphase, _profile.Solver, _profile.Integration,
+                _profile.SubSteps, _profile.Pairs, _profile.Contacts);
         }
     }
 }
\ No newline at end of file
@@ -6,6 +6,24 @@ namespace P3D
 {
     namespace Physics
     {
+        /*
+        Statistics of the last simulation step.
+        Times are in milliseconds and taken from bullet built-in profiler.
+        */
+        struct PhysicsProfile
+        {
+            float Total;        // whole stepSimulation
+            float Broadphase;   // aabbs update and overlapping pairs search
+            float Narrowphase;  // contact generation for overlapping pairs
+            float Solver;       // simulation islands and constraints solving
+            float Integration;  // motion prediction, transforms integration and motion states sync
+            int SubSteps;
+            int Pairs;
+            int Contacts;
+
+            PhysicsProfile() { memset(this, 0, sizeof(PhysicsProfile)); }
+        };
+
         class BulletWorld : 
             public PhysicalWorld
         {
@@ -28,12 +46,35 @@ namespace P3D
             */
             override void Update(TimeCounter& time);
 
+            /*
+            Set continuous collision parameters of the entity.
+            */
+            override void SetContinuousCollision(World::Entity* entity, 
+                Scalar motionThreshold = -1, Scalar sweptSphereRadius = -1);
+
+            /*
+            Sweep convex models along the queries paths.
+            */
+            override void ConvexSweepTest(const SweepQuery* queries, SweepResult* results, uint count);
+
             /*
             PhysicalWorld also acts as class factory for Collision models.
+            Models with equal parameters are shared between entities.
+            */
+            override CollisionModel* CreateBoxCollisionModel(Scalar sx, Scalar sy, Scalar sz);
+            override CollisionModel* CreateSphereCollisionModel(Scalar radius);
+            override CollisionModel* CreateCapsuleCollisionModel(Scalar radius, Scalar height);
+            override CollisionModel* CreateConvexHullCollisionModel(const Vector* points, uint count);
+            override CollisionModel* CreateTriangleMeshCollisionModel(const Vector* vertices, uint vertexCount,
+                const uint* indices, uint indexCount);
+
+            /*
+            Return count of distinct collision models created so far.
             */
-            override CollisionModel* CreateBoxCollisionModel(Scalar sx, Scalar sy, Scalar sz)
+            uint GetCollisionModelCount() const
             {
-                return new BulletBoxCollisionModel(sx, sy, sz);
+                AutoLock lock(_modelsLock);
+                return _models.size();
             }
 
             /*
@@ -41,12 +82,57 @@ namespace P3D
             */
             btDynamicsWorld* GetDynamicsWorld() const { return _world; }
 
+            /*
+            Return statistics of the last simulation step.
+            */
+            const PhysicsProfile& GetLastProfile() const { return _profile; }
+
+            /*
+            Start writing statistics of every step to CSV file.
+            Empty file name stops it.
+            Also enabled by 'profileDump' attribute of 'Physics' config section.
+            */
+            void SetProfileDumpFile(const String& file);
+
         private:
             btBroadphaseInterface* _broadphase;
             btCollisionConfiguration* _collisionConf;
             btCollisionDispatcher* _dispatcher;
             btConstraintSolver* _solver;
             btDynamicsWorld* _world;
+
+            // shared collision models, each holds one reference
+            typedef std::multimap<CollisionModelKey, CollisionModel*> ModelsMap;
+            ModelsMap _models;
+            mutable Lock _modelsLock;
+
+            /*
+            Return AddRef'ed model with the key or NULL.
+            */
+            CollisionModel* FindCollisionModel(const CollisionModelKey& key);
+
+            /*
+            Store model in the cache and return it AddRef'ed.
+            */
+            CollisionModel* AddCollisionModel(const CollisionModelKey& key, CollisionModel* model);
+
+            /*
+            Release all cached models.
+            */
+            void ReleaseCollisionModels();
+
+            PhysicsProfile _profile;
+            CProfileIterator* _profileIterator;
+            FILE* _profileDump;
+            uint _stepNumber;
+
+            /*
+            Fill _profile from bullet profiler and publish it to counters.
+            */
+            void CollectProfile();
+            void WriteProfileDump();
+
+            static Logger logger;
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#if defined(_WIN32)
+#define P3D_WINDOWS
+#define _CRT_SECURE_NO_WARNINGS
+#include "Common/Windows/Includes.h"
+#else
+#define P3D_POSIX
+#include "Common/Posix/Includes.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <string>
+#include <vector>
+
+#include "Common/DataTypes.h"
+
+#define ASSERT(expr) assert(expr)
+#define UNREACHABLE() { ASSERT(0); }
+
+#include "Common/Atomic.h"
+#include "Common/Synchronization.h"
+#include "Common/ThreadLocal.h"
\ No newline at end of file
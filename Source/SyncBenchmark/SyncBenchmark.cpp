@@ -0,0 +1,328 @@
+// SyncBenchmark.cpp : Measures latency and contention of the threading layer.
+//
+// Runs the same scenarios on any platform implementation (Windows or POSIX)
+// so results of the backends can be compared directly.
+
+#include "Includes.h"
+
+using namespace P3D;
+
+typedef Implementation::Thread ThreadImpl;
+
+/*
+Return current time in nanoseconds.
+*/
+double GetTime()
+{
+#if defined(P3D_WINDOWS)
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return double(counter.QuadPart) * 1e9 / double(frequency.QuadPart);
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return double(time.tv_sec) * 1e9 + double(time.tv_nsec);
+#endif
+}
+
+void Report(const char* name, uint threads, double time, double operations)
+{
+    printf("%-32s %7u %12.1f %14.0f\n", name, threads, time / operations, operations * 1e9 / time);
+}
+
+/*
+Runs body in given count of threads started at the same time.
+Return time in nanoseconds from the start till the last thread is finished.
+*/
+class ParallelRun
+{
+public:
+    typedef void (*Body)(void* context, uint index);
+
+    static double Run(uint threads, Body body, void* context)
+    {
+        ParallelRun run(body, context);
+        std::vector<ThreadImpl::ThreadHandle> handles(threads);
+        std::vector<ThreadImpl::ThreadID> ids(threads);
+        std::vector<Args> args(threads);
+        for (uint i = 0; i < threads; i++)
+        {
+            args[i].Run = &run;
+            args[i].Index = i;
+            ThreadImpl::RunThread(&handles[i], &ids[i], _Thread, &args[i], NULL);
+        }
+
+        // let all threads reach the start
+        while (run._ready != (long)threads)
+            ThreadImpl::YieldExecution();
+        double start = GetTime();
+        run._start.Signal();
+        for (uint i = 0; i < threads; i++)
+        {
+            ThreadImpl::Join(handles[i], INFINITE);
+            ThreadImpl::DestroyThreadHandle(handles[i]);
+        }
+        return GetTime() - start;
+    }
+
+private:
+    struct Args
+    {
+        ParallelRun* Run;
+        uint Index;
+    };
+
+    ParallelRun(Body body, void* context)
+        : _body(body), _context(context), _ready(0)
+    { }
+
+    static int _Thread(void* param, void*)
+    {
+        Args* args = (Args*)param;
+        ParallelRun* run = args->Run;
+        AtomicIncrement(&run->_ready);
+        run->_start.Wait();
+        run->_body(run->_context, args->Index);
+        return 0;
+    }
+
+    Body _body;
+    void* _context;
+    volatile long _ready;
+    ManualEvent _start;
+};
+
+enum
+{
+    LockIterations = 2000000,
+    PingPongIterations = 50000,
+    TLSIterations = 10000000
+};
+
+struct LockContext
+{
+    Lock Guard;
+    SpinLock Spin;
+    RWLock ReadWrite;
+    volatile long Counter;
+    uint Iterations;
+};
+
+void LockBody(void* context, uint)
+{
+    LockContext* ctx = (LockContext*)context;
+    for (uint i = 0; i < ctx->Iterations; i++)
+    {
+        ctx->Guard.Enter();
+        ctx->Counter++;
+        ctx->Guard.Leave();
+    }
+}
+
+void SpinLockBody(void* context, uint)
+{
+    LockContext* ctx = (LockContext*)context;
+    for (uint i = 0; i < ctx->Iterations; i++)
+    {
+        ctx->Spin.Enter();
+        ctx->Counter++;
+        ctx->Spin.Leave();
+    }
+}
+
+void SharedLockBody(void* context, uint)
+{
+    LockContext* ctx = (LockContext*)context;
+    for (uint i = 0; i < ctx->Iterations; i++)
+    {
+        ctx->ReadWrite.EnterShared();
+        MemoryFence();
+        ctx->ReadWrite.LeaveShared();
+    }
+}
+
+void AtomicBody(void* context, uint)
+{
+    LockContext* ctx = (LockContext*)context;
+    for (uint i = 0; i < ctx->Iterations; i++)
+        AtomicIncrement(&ctx->Counter);
+}
+
+struct PingPongContext
+{
+    Event Ping;
+    Event Pong;
+
+    PingPongContext() : Ping(Event::AutoReset), Pong(Event::AutoReset)
+    { }
+};
+
+void PingPongBody(void* context, uint index)
+{
+    PingPongContext* ctx = (PingPongContext*)context;
+    for (uint i = 0; i < PingPongIterations; i++)
+    {
+        if (index == 0)
+        {
+            ctx->Ping.Signal();
+            ctx->Pong.Wait();
+        } else
+        {
+            ctx->Ping.Wait();
+            ctx->Pong.Signal();
+        }
+    }
+}
+
+enum { WaitAnyEvents = 8 };
+
+struct WaitAnyContext
+{
+    Event Events[WaitAnyEvents];
+    Event Done;
+
+    WaitAnyContext() : Done(Event::AutoReset)
+    {
+        for (uint i = 0; i < WaitAnyEvents; i++)
+            Events[i].Initialize(Event::AutoReset);
+    }
+};
+
+void WaitAnyBody(void* context, uint index)
+{
+    WaitAnyContext* ctx = (WaitAnyContext*)context;
+    Event* events[WaitAnyEvents];
+    for (uint i = 0; i < WaitAnyEvents; i++)
+        events[i] = &ctx->Events[i];
+
+    for (uint i = 0; i < PingPongIterations; i++)
+    {
+        if (index == 0)
+        {
+            ctx->Events[i % WaitAnyEvents].Signal();
+            ctx->Done.Wait();
+        } else
+        {
+            int signaled = Event::WaitAny(events, WaitAnyEvents);
+            ASSERT(signaled == int(i % WaitAnyEvents));
+            ctx->Done.Signal();
+        }
+    }
+}
+
+void BenchmarkLocks(uint maxThreads)
+{
+    LockContext ctx;
+    ctx.Iterations = LockIterations;
+
+    // uncontended path is the common case
+    ctx.Counter = 0;
+    double start = GetTime();
+    LockBody(&ctx, 0);
+    Report("Lock uncontended", 1, GetTime() - start, LockIterations);
+
+    for (uint threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        ctx.Counter = 0;
+        ctx.Iterations = LockIterations / threads;
+        double time = ParallelRun::Run(threads, LockBody, &ctx);
+        ASSERT(ctx.Counter == long(ctx.Iterations * threads));
+        Report("Lock contended", threads, time, ctx.Iterations * threads);
+    }
+
+    for (uint threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        ctx.Counter = 0;
+        ctx.Iterations = LockIterations / threads;
+        double time = ParallelRun::Run(threads, SpinLockBody, &ctx);
+        ASSERT(ctx.Counter == long(ctx.Iterations * threads));
+        Report("SpinLock contended", threads, time, ctx.Iterations * threads);
+    }
+
+    // readers don't serialize each other
+    for (uint threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        ctx.Iterations = LockIterations / threads;
+        double time = ParallelRun::Run(threads, SharedLockBody, &ctx);
+        Report("RWLock shared", threads, time, ctx.Iterations * threads);
+    }
+
+    ctx.Counter = 0;
+    ctx.Iterations = LockIterations;
+    start = GetTime();
+    AtomicBody(&ctx, 0);
+    Report("AtomicIncrement uncontended", 1, GetTime() - start, LockIterations);
+
+    for (uint threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        ctx.Counter = 0;
+        ctx.Iterations = LockIterations / threads;
+        double time = ParallelRun::Run(threads, AtomicBody, &ctx);
+        Report("AtomicIncrement contended", threads, time, ctx.Iterations * threads);
+    }
+}
+
+void BenchmarkEvents()
+{
+    // round trip is two wakeups
+    PingPongContext pingPong;
+    double time = ParallelRun::Run(2, PingPongBody, &pingPong);
+    Report("Event wakeup", 2, time, PingPongIterations * 2);
+
+    WaitAnyContext waitAny;
+    time = ParallelRun::Run(2, WaitAnyBody, &waitAny);
+    Report("Event::WaitAny wakeup", 2, time, PingPongIterations * 2);
+
+    // signaled events only
+    Event a(Event::SetSignaled), b(Event::SetSignaled);
+    double start = GetTime();
+    for (uint i = 0; i < PingPongIterations; i++)
+        Event::WaitAll(a, b);
+    Report("Event::WaitAll signaled", 1, GetTime() - start, PingPongIterations);
+}
+
+void BenchmarkThreadLocal()
+{
+    ThreadLocal<int> local;
+    int value = 0;
+    local.Set(&value);
+
+    double start = GetTime();
+    int sum = 0;
+    for (uint i = 0; i < TLSIterations; i++)
+    {
+        sum += *local.Get();
+        MemoryFence(); // don't let the compiler hoist the read
+    }
+    Report("ThreadLocal::Get", 1, GetTime() - start, TLSIterations);
+
+    start = GetTime();
+    for (uint i = 0; i < TLSIterations; i++)
+    {
+        sum += ThreadImpl::GetCurrentThreadID() != 0;
+        MemoryFence();
+    }
+    Report("GetCurrentThreadID", 1, GetTime() - start, TLSIterations);
+
+    if (sum == 42) printf("\n"); // keep the loops
+}
+
+int main(int argc, char** argv)
+{
+    uint processors = ThreadImpl::GetProcessorCount();
+    uint maxThreads = argc > 1 ? atoi(argv[1]) : processors;
+    if (maxThreads < 2) maxThreads = 2;
+
+#if defined(P3D_WINDOWS)
+    printf("Backend: Windows, %u processors\n", processors);
+#else
+    printf("Backend: POSIX, %u processors\n", processors);
+#endif
+    printf("%-32s %7s %12s %14s\n", "Test", "Threads", "ns/op", "ops/s");
+
+    BenchmarkLocks(maxThreads);
+    BenchmarkEvents();
+    BenchmarkThreadLocal();
+    return 0;
+}
\ No newline at end of file
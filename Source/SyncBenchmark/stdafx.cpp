@@ -0,0 +1 @@
+#include "Includes.h"
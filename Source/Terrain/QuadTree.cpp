@@ -5,6 +5,8 @@ namespace P3D
 {
     namespace World
     {
+        DEFINE_SLAB_NEW(QuadTreeNode, "QuadTreeNode");
+
         const Sphere& QuadTreeNodeBase::CalculateBoundingSphere()
         {
             // get bounding sphere from bounding box
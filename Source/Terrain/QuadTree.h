@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Common/SlabAllocator.h"
+
 namespace P3D
 {
     namespace World
@@ -51,6 +53,8 @@ namespace P3D
                 IsLeaf = false;
             }
 
+            DECLARE_SLAB_NEW();
+
             override const AABB& CalculateBoundingBox();
 
             /*
@@ -1,11 +1,12 @@
 #include "Includes.h"
 #include "QuadTreeRenderer.h"
+#include "Common/Profiler.h"
 
 namespace P3D
 {
     namespace World
     {
-        int gQuadTreeChecks = 0;
+        Counter gQuadTreeChecks("Terrain.QuadTreeChecks", "nodes");
 
         static forceinline void GetTraversalOrder(const Vector& cam, byte* traversalOrder)
         {
@@ -49,6 +50,8 @@ namespace P3D
 
         void QuadTreeRenderer::Render(QuadTreeNodeBase* root, const Camera& camera, const Transform& camToObj, const Transform& objToCam)
         {
+            PROFILE_SCOPE("QuadTreeRenderer.Render");
+
             // obtain from camera
             _camera = &camera;
             _viewFrustum = camera.GetFrustum();
@@ -68,7 +71,6 @@ namespace P3D
             VisibleLeafs.clear();
 
             _tick++; // update tick so all previous visible leafs are no longer visible
-            gQuadTreeChecks = 0; // reset counter
 
             // start recursive check
             if (root)
@@ -83,7 +85,7 @@ namespace P3D
 
         QuadTreeRenderer::VisibilityTestResult QuadTreeRenderer::IsVisible(const QuadTreeNodeBase* node, int cullingMask, int& newCullingMask) const
         {
-            gQuadTreeChecks++;
+            gQuadTreeChecks.Increment();
 
             ///////////////////////
             /// Frustum test
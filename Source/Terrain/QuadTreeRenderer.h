@@ -1,12 +1,13 @@
 #pragma once
 
 #include "QuadTree.h"
+#include "Common/Metrics.h"
 
 namespace P3D
 {
     namespace World
     {
-        extern int gQuadTreeChecks;
+        extern Counter gQuadTreeChecks;
 
         /*
         Assembles list of visible patches.
@@ -1,5 +1,6 @@
 #include "Includes.h"
 #include "Terrain.h"
+#include "Common/Profiler.h"
 
 namespace P3D
 {
@@ -7,7 +8,7 @@ namespace P3D
     {
         Logger Terrain::logger(L"World.Terrain");
 
-        int gPatchRebuilds = 0;
+        Counter gPatchRebuilds("Terrain.PatchRebuilds", "patches");
 
         Terrain::Terrain(World* world)
             : Entity(world)
@@ -91,7 +92,7 @@ namespace P3D
 
         void Terrain::Load(const wchar* file, int width, int height, float meshStepX, float meshStepY)
         {
-            logger.info() << L"Loading " << width << L"x" << height 
+            log_info(logger) << L"Loading " << width << L"x" << height 
                 << L" terrain from '" << file << L"'...";
 
             // reset stats
@@ -113,7 +114,7 @@ namespace P3D
 
             // create and load map
             {
-                logger.info() << L"Loading height map (" 
+                log_info(logger) << L"Loading height map (" 
                     << width * height * sizeof(HeightMapPixel) << L" bytes)...";
 
                 _map = (HeightMapPixel*)malloc(width * height * sizeof(HeightMapPixel));
@@ -188,7 +189,7 @@ namespace P3D
             _patchesSX = _sizeX / (PATCH_SIZE - 1);
             _patchesSY = _sizeY / (PATCH_SIZE - 1);
 
-            logger.info() << L"Building " << _patchesSX << L"x" << _patchesSY
+            log_info(logger) << L"Building " << _patchesSX << L"x" << _patchesSY
                 << L" patch list (" 
                 << _patchesSX * _patchesSY * (sizeof(void*) + sizeof(TerrainPatch))
                 << L" bytes)...";
@@ -222,23 +223,24 @@ namespace P3D
             }
 
             // link into quad tree
-            logger.info() << L"Building terrain quad tree...";
+            log_info(logger) << L"Building terrain quad tree...";
             _quadRoot = BuildQuadTree(0, _patchesSX, 0, _patchesSY, NULL);
 
-            logger.info() << L"Creating index buffers...";
+            log_info(logger) << L"Creating index buffers...";
             for (ClustersIterator i = _clusters.begin(); i != _clusters.end(); i++)
                 i->second.IB->Initialize(i->second.IBSize, BUFFER_DYNAMIC);
 
             // calculate total AABB
-            logger.info() << L"Calculating bounding boxes...";
+            log_info(logger) << L"Calculating bounding boxes...";
             _quadRoot->CalculateBoundingBox();
 
-            logger.info() << L"Terrain building complete!";
-            logger.info() << L"Total RAM used : " << _memoryUsed / 1024 << L" Kb.";
-            logger.info() << L"Quad Nodes used: " << _quadNodeCount <<L" (" << _quadNodeCount*sizeof(QuadTreeNode) / 1024 << L" Kb total).";
-            logger.info() << L"Vertex Buffers used: " << _clusters.size() << L" (" << _vbTotalSize / 1024 << L" Kb total).";
-            logger.info() << L"Index Buffers used : " << _clusters.size() << L" (" 
+            log_info(logger) << L"Terrain building complete!";
+            log_info(logger) << L"Total RAM used : " << _memoryUsed / 1024 << L" Kb.";
+            log_info(logger) << L"Quad Nodes used: " << _quadNodeCount <<L" (" << _quadNodeCount*sizeof(QuadTreeNode) / 1024 << L" Kb total).";
+            log_info(logger) << L"Vertex Buffers used: " << _clusters.size() << L" (" << _vbTotalSize / 1024 << L" Kb total).";
+            log_info(logger) << L"Index Buffers used : " << _clusters.size() << L" (" 
                 << _patchesSX*_patchesSY*TerrainPatch::MAX_INDICES_COUNT * sizeof(TerrainPatch::IndexType) / 1024 << L" Kb total).";
+            SlabAllocator::WriteReport(logger);
         }
 
         void Terrain::DestroyPatches()
@@ -318,8 +320,7 @@ namespace P3D
         void Terrain::DoRender(const RendererContext& params)
         {
             if (!_patches) return;
-
-            gPatchRebuilds = 0;
+            PROFILE_SCOPE("Terrain.DoRender");
 
             // get camera
             const Camera* camera = GetWorld()->GetActiveCamera();
@@ -339,10 +340,13 @@ namespace P3D
             _activeIndexBuffer = NULL;
 
             // calculate errors
-            for (uint i = 0; i < _renderer.VisibleLeafs.size(); ++i)
             {
-                TerrainPatch* cur = (TerrainPatch*)_renderer.VisibleLeafs[i];
-                cur->CalculateLOD(camToObj);
+                PROFILE_SCOPE("Terrain.CalculateLOD");
+                for (uint i = 0; i < _renderer.VisibleLeafs.size(); ++i)
+                {
+                    TerrainPatch* cur = (TerrainPatch*)_renderer.VisibleLeafs[i];
+                    cur->CalculateLOD(camToObj);
+                }
             }
 
             // make patches with common side have lods differ no more than by 1
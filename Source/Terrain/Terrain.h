@@ -8,7 +8,7 @@ namespace P3D
 {
     namespace World
     {
-        extern int gPatchRebuilds;
+        extern Counter gPatchRebuilds;
 
         class Terrain : 
             public Entity
@@ -8,6 +8,8 @@ namespace P3D
 {
     namespace World
     {
+        DEFINE_SLAB_NEW(TerrainPatch, "TerrainPatch");
+
         TerrainPatch::TerrainPatch(Terrain* parent, int x, int y)
         {
             _parent = parent;
@@ -90,7 +92,7 @@ namespace P3D
             _indecesCount = renderer.GetWrittenIndicesCount();
             IB->Copy(indexBuffer, _indecesCount, _indexOffset);
 
-            gPatchRebuilds++;
+            gPatchRebuilds.Increment();
         }
 
         void TerrainPatch::Render()
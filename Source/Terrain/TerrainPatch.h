@@ -31,6 +31,9 @@ namespace P3D
             TerrainPatch(Terrain* parent, int x, int y);
             ~TerrainPatch();
 
+            // patches of the terrain are allocated together in slabs
+            DECLARE_SLAB_NEW();
+
             /*
             Inherited from QuadTreeLeaf.
             */
@@ -10,41 +10,50 @@
 #include "Common/ObjectPool.h"
 #include "Common/Command.h"
 #include "Common/Lazy.h"
+#include "Common/Config.h"
+#include "Common/Profiler.h"
+#include "Common/Metrics.h"
+#include "Common/FrameArena.h"
+#include "Common/HeapMonitor.h"
 
 using namespace P3D;
 using namespace P3D::Graphics;
 using namespace P3D::World;
 
-class OpenGLTest : 
-    public RenderWindow
+// input events of the test recorded by WorldRecorder
+enum TestEvent
 {
-    TimeCounter fps;
-    uint frames;
-    float _fps;
+    Event_KeyDown = 1,  // key
+    Event_KeyUp,        // key
+    Event_Turn          // dx, dy
+};
 
+/*
+Test world. Shared by interactive window and headless replay.
+*/
+class TestScene :
+    public ReplayListener
+{
+public:
     P3D::World::World world;
     FlyingCamera* cam;
-    bool _boost;
-    bool _firstMove;
-
     Terrain* ter;
-    SmartPointer<Texture> tex;
-public:
+    bool _boost;
 
-    OpenGLTest() :
+    TestScene() :
       world(Physics::CreatePhysicalWorld())
-    { }
-
-    virtual void OnInitialize()
     {
-        Graphics::RenderWindow::OnInitialize();
-
-        const char* ext = (const char*)glGetString(GL_EXTENSIONS);
-
-        SetCursorVisible(false);
-        SetCursorPosition(400, 300);
-        _firstMove = true;
+        cam = NULL;
+        ter = NULL;
+        _boost = false;
+    }
 
+    /*
+    Create entities. Terrain needs renderer so it is not available in headless mode.
+    It is added last to keep order of other entities the same for replays.
+    */
+    void Build(bool withTerrain)
+    {
         {
             cam = new FlyingCamera(&world);
             QTransform tr;
@@ -75,6 +84,7 @@ public:
         {
             P3D::World::Box* box = new P3D::World::Box(&world, 0.5f, 0.5f, 0.5f);
             box->SetMass(1.0);
+            world.GetPhysicalWorld()->SetContinuousCollision(box); // small and fast, prevent tunneling
             QTransform tr;
             tr.SetIdentity();
             tr.Translation.Set(0, 0, 1.0f * i + 2.0f);
@@ -84,12 +94,117 @@ public:
         }
         world.AddEntity(compound);
 
-        tex.Attach(GetTextureManager()->LoadTexture(L"SceneTexture.jpg"));
+        if (withTerrain)
+        {
+            ter = new Terrain(&world);
+            ter->Load(L"Scene2.raw", 512, 512, 16.0f, 16.0f);
+            //ter->Load(L"Plain.raw", 256, 256, 4.0f, 4.0f);
+            world.AddEntity(ter);
+        }
+    }
+
+    void HandleEvent(const ReplayEvent& event)
+    {
+        switch (event.Type)
+        {
+            case Event_KeyDown:
+                HandleKey((SDLKey)event.Params[0], true);
+                break;
+            case Event_KeyUp:
+                HandleKey((SDLKey)event.Params[0], false);
+                break;
+            case Event_Turn:
+                cam->Turn(event.Params[0] / 350.0f, - event.Params[1] / 350.0f);
+                break;
+        }
+    }
+
+    override void OnReplayEvent(const ReplayEvent& event)
+    {
+        HandleEvent(event);
+    }
+
+private:
+    void HandleKey(SDLKey key, bool down)
+    {
+        if (key == SDLK_w)
+        {
+            cam->Forward(down);
+            return;
+        }
+        if (key == SDLK_s)
+        {
+            cam->Backward(down);
+            return;
+        }
+        if (key == SDLK_a)
+        {
+            cam->Left(down);
+            return;
+        }
+        if (key == SDLK_d)
+        {
+            cam->Right(down);
+            return;
+        }
+        if (key == SDLK_q)
+        {
+            cam->Up(down);
+            return;
+        }
+        if (key == SDLK_e)
+        {
+            cam->Down(down);
+            return;
+        }
+        if (key == SDLK_LSHIFT && down)
+        {
+            _boost = !_boost;
+            cam->Boost(_boost);
+            return;
+        }
+    }
+};
 
-        ter = new Terrain(&world);
-        ter->Load(L"Scene2.raw", 512, 512, 16.0f, 16.0f);
-        //ter->Load(L"Plain.raw", 256, 256, 4.0f, 4.0f);
-        world.AddEntity(ter);
+class OpenGLTest : 
+    public RenderWindow
+{
+    TimeCounter fps;
+    uint frames;
+    float _fps;
+
+    TestScene scene;
+    P3D::World::World& world;
+    bool _firstMove;
+
+    WorldRecorder recorder;
+    SmartPointer<Texture> tex;
+public:
+
+    OpenGLTest() :
+      world(scene.world)
+    { }
+
+    virtual void OnInitialize()
+    {
+        Graphics::RenderWindow::OnInitialize();
+
+        const char* ext = (const char*)glGetString(GL_EXTENSIONS);
+
+        SetCursorVisible(false);
+        SetCursorPosition(400, 300);
+        _firstMove = true;
+
+        scene.Build(true);
+
+        String record = Config::GetInstance().ReadWideString("Replay", "record");
+        if (!record.empty()) recorder.Start(record, &world);
+
+        Profiler::Configure();
+        Metrics::Configure();
+        HeapMonitor::Start();
+
+        tex.Attach(GetTextureManager()->LoadTexture(L"SceneTexture.jpg"));
 
         glEnable(GL_DEPTH_TEST);
         //glEnable(GL_LIGHTING);
@@ -121,20 +236,26 @@ public:
 
     virtual void OnDeinitialize()
     {
+        recorder.Stop();
+        Profiler::StopCapture();
+        Metrics::StopExport();
+        HeapMonitor::Stop();
         Graphics::RenderWindow::OnDeinitialize();
     }
 
     virtual void OnRender()
     {
+        Profiler::BeginFrame();
         fps.Tick();
         double tick = fps.GetLastTick() / 1000.0;
         CalculateFPS();
 
         world.Update();
+        recorder.RecordTick(world.Time().GetLastTick());
 
         glEnable(GL_TEXTURE_2D);
         tex->Bind();
-        world.Render(cam);
+        world.Render(scene.cam);
         tex->Unbind();
         glDisable(GL_TEXTURE_2D);
 
@@ -149,102 +270,109 @@ public:
         glColor3f(1.0f, 1.0f, 1.0f);
         {
             if (_fps > 10000) _fps = 0;
-            std::ostringstream str;
+            FrameStringStream str;
             str << "FPS: " << _fps;
             OutputText(10, 20, 0, str.str().c_str());
         }
 
         {
-            std::ostringstream str;
-            str << "Entities: " << g_EntitiesRendered;
+            FrameStringStream str;
+            str << "Entities: " << g_EntitiesRendered.GetFrameValue();
             OutputText(10, 40, 0, str.str().c_str());
         }
 
         {
-            std::ostringstream str;
-            str << "Polygons: " << g_PolygonCounter;
+            FrameStringStream str;
+            str << "Polygons: " << g_PolygonCounter.GetFrameValue();
             OutputText(10, 60, 0, str.str().c_str());
         }
-        glPopAttrib();
-    }
 
-    virtual void OnKeyDown(SDL_keysym key)
-    {
-        if (key.sym == SDLK_ESCAPE) 
         {
-            Close();
-            return;
-        }
-        if (key.sym == SDLK_w)
-        {
-            cam->Forward(true);
-            return;
+            FrameStringStream str;
+            str << "Physics: " << g_PhysicsStepTime.Get() << " us, pairs: " << g_PhysicsPairs.Get() 
+                << ", contacts: " << g_PhysicsContacts.Get();
+            OutputText(10, 80, 0, str.str().c_str());
         }
-        if (key.sym == SDLK_s)
-        {
-            cam->Backward(true);
-            return;
-        }
-        if (key.sym == SDLK_a)
+
         {
-            cam->Left(true);
-            return;
+            ObjectPoolBase::Stats stats = ObjectPool<Boxed<ManualEvent> >::GetInstance().GetStats();
+            FrameStringStream str;
+            str << "Event pool: " << stats.Hits << " hits, " << stats.Misses << " misses, " 
+                << stats.Outstanding << " in use";
+            OutputText(10, 100, 0, str.str().c_str());
         }
-        if (key.sym == SDLK_d)
+
         {
-            cam->Right(true);
-            return;
+            Metrics::Sample sample;
+            if (Metrics::GetSample("Physics.StepTimes", sample) && sample.Total > 0)
+            {
+                FrameStringStream str;
+                str << "Physics steps: " << sample.Total << ", p50 < " << sample.P50 
+                    << " us, p95 < " << sample.P95 << " us";
+                OutputText(10, 120, 0, str.str().c_str());
+            }
         }
-        if (key.sym == SDLK_q)
+
+        if (Profiler::IsEnabled())
         {
-            cam->Up(true);
-            return;
+            // slowest scopes of the previous frame
+            const std::vector<Profiler::SummaryEntry>& summary = Profiler::GetFrameSummary();
+            FrameStringStream str;
+            str.setf(std::ios::fixed);
+            str.precision(2);
+            str << "Frame: " << Profiler::GetFrameTime() << " ms";
+            OutputText(10, 140, 0, str.str().c_str());
+            for (uint i = 0; i < summary.size() && i < 5; i++)
+            {
+                FrameStringStream line;
+                line.setf(std::ios::fixed);
+                line.precision(2);
+                line << "  " << summary[i].Name << ": " << summary[i].Total << " ms, " << summary[i].Calls << " calls";
+                OutputText(10, 160 + i * 20, 0, line.str().c_str());
+            }
         }
-        if (key.sym == SDLK_e)
+
         {
-            cam->Down(true);
-            return;
+            // heap allocations should stay at zero once frame sizes are settled
+            Metrics::Sample bytes, heap;
+            if (Metrics::GetSample("Memory.FrameArena", bytes) && Metrics::GetSample("Memory.HeapAllocations", heap))
+            {
+                FrameStringStream str;
+                str << "Frame arena: " << bytes.Value / 1024 << " KB, heap allocations: " << heap.Value
+                    << " (" << heap.Total << " total)";
+                OutputText(10, 260, 0, str.str().c_str());
+            }
         }
-        if (key.sym == SDLK_LSHIFT)
+        glPopAttrib();
+
+        Profiler::EndFrame();
+        HeapMonitor::EndFrame();
+        Metrics::EndFrame();
+        FrameArena::EndFrame();
+    }
+
+    /*
+    Record input event and handle it.
+    */
+    void ProcessEvent(const ReplayEvent& event)
+    {
+        recorder.RecordEvent(event);
+        scene.HandleEvent(event);
+    }
+
+    virtual void OnKeyDown(SDL_keysym key)
+    {
+        if (key.sym == SDLK_ESCAPE) 
         {
-            _boost = !_boost;
-            cam->Boost(_boost);
+            Close();
             return;
         }
+        ProcessEvent(ReplayEvent(Event_KeyDown, key.sym));
     }
 
     virtual void OnKeyUp(SDL_keysym key)
     {
-        if (key.sym == SDLK_w)
-        {
-            cam->Forward(false);
-            return;
-        }
-        if (key.sym == SDLK_s)
-        {
-            cam->Backward(false);
-            return;
-        }
-        if (key.sym == SDLK_a)
-        {
-            cam->Left(false);
-            return;
-        }
-        if (key.sym == SDLK_d)
-        {
-            cam->Right(false);
-            return;
-        }
-        if (key.sym == SDLK_q)
-        {
-            cam->Up(false);
-            return;
-        }
-        if (key.sym == SDLK_e)
-        {
-            cam->Down(false);
-            return;
-        }
+        ProcessEvent(ReplayEvent(Event_KeyUp, key.sym));
     }
 
     virtual void OnMouseMove(int dx, int dy, int mx, int my)
@@ -258,14 +386,30 @@ public:
         dy = my - 300;
         if (dx != 0 || dy != 0)
         {
-            Logger logger(L"MouseMove");
             SetCursorPosition(400, 300);
-            cam->Turn(dx / 350.0f, - dy / 350.0f);
+            ProcessEvent(ReplayEvent(Event_Turn, dx, dy));
         }
     }
 };
 
+/*
+Play recorded session without window and write timings to the log.
+*/
+int RunReplay(const String& file)
+{
+    TestScene scene;
+    scene.Build(false);
+
+    WorldReplay replay;
+    if (!replay.Start(file, &scene.world)) return 1;
+    replay.AddListener(&scene);
+    replay.Run();
+    return 0;
+}
+
 int P2DMain()
 {
+    String play = Config::GetInstance().ReadWideString("Replay", "play");
+    if (!play.empty()) return RunReplay(play);
     return OpenGLTest().Run();
-}
+}
\ No newline at end of file
@@ -15,8 +15,7 @@ namespace P3D
         };
 
         Camera::Camera(World* world)
-            : Entity(world),
-            _frustum(this, &Camera::RecalculateFrustum)
+            : Entity(world)
         {
             _fov = (float)(M_PI / 4.0f);
             _aspectRatio = 1.3333f;
@@ -34,7 +34,7 @@ namespace P3D
             /*
             Set field of view value expressed in radians.
             */
-            inline void SetFOV(float fov) { _fov = fov; _frustum.Invalidate(); }
+            inline void SetFOV(float fov) { _fov = fov; LazyFrustum::Invalidate(_cameraDirty); }
 
             /*
             Get 'screen plane width' / 'screen plane height'.
@@ -44,7 +44,7 @@ namespace P3D
             /*
             Set 'screen plane width' / 'screen plane height'.
             */
-            inline void SetAspectRatio(float aspectRatio) { _aspectRatio = aspectRatio; _frustum.Invalidate(); }
+            inline void SetAspectRatio(float aspectRatio) { _aspectRatio = aspectRatio; LazyFrustum::Invalidate(_cameraDirty); }
 
             /*
             Get near projection plane.
@@ -54,7 +54,7 @@ namespace P3D
             /*
             Set near projection plane.
             */
-            inline void SetNearPlane(float nearPlane) { _nearPlane = nearPlane; _frustum.Invalidate(); }
+            inline void SetNearPlane(float nearPlane) { _nearPlane = nearPlane; LazyFrustum::Invalidate(_cameraDirty); }
 
             /*
             Get far projection plane.
@@ -64,17 +64,17 @@ namespace P3D
             /*
             Set far projection plane.
             */
-            inline void SetFarPlane(float farPlane) { _farPlane = farPlane; _frustum.Invalidate(); }
+            inline void SetFarPlane(float farPlane) { _farPlane = farPlane; LazyFrustum::Invalidate(_cameraDirty); }
 
             /*
             Get coresponding Frustum object in camera space.
             */
-            inline const Frustum& GetFrustum() const { return _frustum(); }
+            inline const Frustum& GetFrustum() const { return _frustum.Get(this, _cameraDirty); }
             
             /*
             Return sphere (in object space) that encloses all frustrum.
             */
-            inline const Sphere& GetBoundingSphere() const { _frustum.Update(); return _sphere; }
+            inline const Sphere& GetBoundingSphere() const { _frustum.Update(this, _cameraDirty); return _sphere; }
 
             /*
             Rotate camera so it looks at specific direction.
@@ -96,7 +96,11 @@ namespace P3D
             float _aspectRatio;
             float _nearPlane, _farPlane;
 
-            Lazy<Camera, Frustum> _frustum;
+            enum { Dirty_Frustum = 1 << 0 };
+            typedef Lazy<Camera, Frustum, &Camera::RecalculateFrustum, Dirty_Frustum> LazyFrustum;
+
+            LazyFrustum _frustum;
+            mutable DirtyFlags _cameraDirty;
             Sphere _sphere;
         };
     }
@@ -13,7 +13,11 @@ namespace P3D
         public:
             enum ModelType
             {
-                Box
+                Box,
+                Sphere,
+                Capsule,
+                ConvexHull,
+                TriangleMesh
             };
 
         protected:
@@ -5,8 +5,10 @@ namespace P3D
 {
     namespace World
     {
+        static Counter g_BoundingBoxRefits("World.BoundingBoxRefits", "refits");
+
         CompoundEntity::CompoundEntity(World* world)
-            : Entity(world)
+            : Entity(world), _bboxValid(false)
         {
         }
 
@@ -23,8 +25,10 @@ namespace P3D
 
             if (Contains(entity)) return;
             entity->_parent = this;
+            entity->_bboxQueued = false;
             _childs.push_back(entity);
 
+            _bboxValid = false;
             InvalidateBoundingBox();
         }
 
@@ -33,9 +37,15 @@ namespace P3D
             ChildsContainer::iterator it = std::find(_childs.begin(), _childs.end(), entity);
             if (it == _childs.end()) return; // no such child
             _childs.erase(it);
+            if (entity->_bboxQueued)
+            {
+                _changedChilds.erase(std::find(_changedChilds.begin(), _changedChilds.end(), entity));
+                entity->_bboxQueued = false;
+            }
             entity->_parent = NULL;
             entity->Release();
 
+            _bboxValid = false;
             InvalidateBoundingBox();
         }
 
@@ -63,7 +73,11 @@ namespace P3D
             if (Entity::Update())
             {
                 for (ChildsContainer::const_iterator it = _childs.begin(); it != _childs.end(); ++it)
+                {
+                    // resting bodies keep their transform and bounding box
+                    if ((*it)->IsSleeping()) continue;
                     (*it)->Update();
+                }
                 return true;
             } else
                 return false;
@@ -76,7 +90,7 @@ namespace P3D
                 (*it)->Prepare();
         }
 
-        void CompoundEntity::InvalidatTransformToWorldSpace()
+        void CompoundEntity::InvalidateTransformToWorldSpace()
         {
             Entity::InvalidateTransformToWorldSpace();
 
@@ -85,13 +99,57 @@ namespace P3D
                 (*it)->InvalidateTransformToWorldSpace();
         }
 
+        void CompoundEntity::ChildBoundingBoxChanged(Entity* child)
+        {
+            _changedChilds.push_back(child);
+            InvalidateBoundingBox();
+        }
+
         void CompoundEntity::RecalculateBoundingBox(AABB& box)
         {
+            // box holds the previous value
+            if (!_bboxValid)
+            {
+                for (ChildsContainer::iterator it = _childs.begin(); it != _childs.end(); ++it)
+                {
+                    Entity* child = *it;
+                    child->_bboxInParent = child->GetBoundingBoxInParentSpace(); // impossible for invisible
+                    child->_bboxQueued = false;
+                }
+                _changedChilds.clear();
+                RefitBoundingBox(box);
+                _bboxValid = true;
+                return;
+            }
+
+            // childs that stay inside the box only enlarge it,
+            // the box can shrink only when a child touching its faces moves
+            bool refit = false;
+            for (uint i = 0; i < _changedChilds.size(); i++)
+            {
+                Entity* child = _changedChilds[i];
+                const AABB& old = child->_bboxInParent;
+                if (!old.IsImpossible() && !box.IsStrictlyInside(old)) refit = true;
+
+                child->_bboxInParent = child->GetBoundingBoxInParentSpace();
+                child->_bboxQueued = false;
+                if (!refit && !child->_bboxInParent.IsImpossible())
+                    box.Enlarge(child->_bboxInParent);
+            }
+            _changedChilds.clear();
+
+            if (refit) RefitBoundingBox(box);
+        }
+
+        void CompoundEntity::RefitBoundingBox(AABB& box)
+        {
+            // boxes of childs are already up to date
+            g_BoundingBoxRefits.Increment();
             box.SetImpossible();
             for (ChildsContainer::iterator it = _childs.begin(); it != _childs.end(); ++it)
             {
-                if (!(*it)->IsVisible()) continue;
-                box.Enlarge((*it)->GetBoundingBoxInParentSpace());
+                const AABB& childBox = (*it)->_bboxInParent;
+                if (!childBox.IsImpossible()) box.Enlarge(childBox);
             }
         }
     }
@@ -12,7 +12,11 @@ namespace P3D
         */
         class CompoundEntity : public Entity
         {
+            friend class Entity;
+
         public:
+            typedef std::list<Entity*> ChildsContainer;
+
             CompoundEntity(World* world);
             virtual ~CompoundEntity();
 
@@ -44,6 +48,11 @@ namespace P3D
             */
             bool Contains(Entity* entity) const;
 
+            /*
+            Return child entities in order they were added.
+            */
+            const ChildsContainer& GetChilds() const { return _childs; }
+
             /*
             Simulate physics, do thinking etc.
             */
@@ -63,16 +72,30 @@ namespace P3D
             /*
             Says that entity should recalculate transform to world space.
             */
-            override void InvalidatTransformToWorldSpace();
+            override void InvalidateTransformToWorldSpace();
 
             /*
             Recalculate bounding box.
             */
             override void RecalculateBoundingBox(AABB& box);
 
+        private:
+            /*
+            Remember that child's box has changed, it is accounted on the next bounding box query.
+            */
+            void ChildBoundingBoxChanged(Entity* child);
+
+            /*
+            Rebuild bounding box from boxes of all childs.
+            */
+            void RefitBoundingBox(AABB& box);
+
         protected:
-            typedef std::list<Entity*> ChildsContainer;
             ChildsContainer _childs;
+
+        private:
+            std::vector<Entity*> _changedChilds;
+            bool _bboxValid; // false when box should be rebuilt from all childs
         };
     }
 }
\ No newline at end of file
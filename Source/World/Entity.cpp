@@ -8,18 +8,15 @@ namespace P3D
 {
     namespace World
     {
-        Entity::Entity(World* world) : 
-            _transform(this, &Entity::RecalculateTransform),
-            _invTransform(this, &Entity::RecalculateInvTransform),
-            _toWorldSpace(this, &Entity::RecalculateTransformToWorld),
-            _bbox(this, &Entity::RecalculateBoundingBox),
-            _bboxInPS(this, &Entity::RecalculateBoundingBoxInPS),
+        DEFINE_SLAB_NEW(Entity, "Entity");
 
+        Entity::Entity(World* world) : 
             _parentWorld(world),
-            _parent(NULL),
+            _parent(NULL), _bboxQueued(false),
             _lastUpdateTick(0), _visible(true),
             _controller(NULL), _controllerData(NULL),
-            _prepareCalled(false), _mass(0.0f)
+            _prepareCalled(false), _mass(0.0f),
+            _ccdMotionThreshold(0.0f), _ccdSweptSphereRadius(0.0f)
         {
             _objectTransform.SetIdentity();
 
@@ -49,7 +46,7 @@ namespace P3D
                 SetTransform(parentToWorld * transform);
             } else
                 SetTransform(transform);
-            _toWorldSpace.Set(transform);
+            _toWorldSpace.Set(transform, _dirty);
         }
 
         bool Entity::NeedUpdate()
@@ -65,11 +62,17 @@ namespace P3D
             uint ticks = GetWorld()->Time().GetTicks();
             if (ticks == _lastUpdateTick) return false; // already simulated
             _lastUpdateTick = ticks;
-            if (_controller)
+            if (_controller && !_controller->IsSleeping(this))
                 _controller->UpdateEntity(this, GetWorld()->Time());
             return true;
         }
 
+        void Entity::QueueBoundingBoxInParent()
+        {
+            _bboxQueued = true;
+            _parent->ChildBoundingBoxChanged(this);
+        }
+
         void Entity::RecalculateTransformToWorld(QTransform& transform)
         {
             if (_parent)
@@ -86,7 +89,7 @@ namespace P3D
             if (((params.Flags & RF_RenderAll) != 0) ||
                 params.GetFrustum().Intersects(GetBoundingBoxInParentSpace()) != OUTSIDE)
             {
-                IncCounter(g_EntitiesRendered);
+                g_EntitiesRendered.Increment();
 
                 glPushMatrix();
                 ApplyTransform();
@@ -122,6 +125,32 @@ namespace P3D
                 _controller->Bind(this);
         }
 
+        void Entity::SetContinuousCollision(Scalar motionThreshold, Scalar sweptSphereRadius)
+        {
+            _ccdMotionThreshold = motionThreshold;
+            _ccdSweptSphereRadius = sweptSphereRadius;
+            if (_controller && _prepareCalled)
+                _controller->ParametersChanged(this);
+        }
+
+        bool Entity::Sweep(const QTransform& to, Physics::SweepResult& result) const
+        {
+            Physics::PhysicalWorld* physicalWorld = _parentWorld->GetPhysicalWorld();
+            if (!physicalWorld || !_collisionModel) 
+            {
+                result.Hit = false;
+                return false;
+            }
+
+            Physics::SweepQuery query;
+            query.Model = _collisionModel;
+            query.From = GetTransformToWorldSpace();
+            query.To = to;
+            query.Ignore = this;
+            physicalWorld->ConvexSweepTest(&query, &result, 1);
+            return result.Hit;
+        }
+
         void Entity::Prepare()
         {
             if (_prepareCalled) return;
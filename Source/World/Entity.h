@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CollisionModel.h"
+#include "Common/SlabAllocator.h"
 
 namespace P3D
 {
@@ -38,6 +39,11 @@ namespace P3D
             Entity(World* parent);
             virtual ~Entity();
 
+            /*
+            Entities of all classes are allocated in slabs.
+            */
+            DECLARE_SLAB_NEW();
+
             /*
             Return entity class.
             */
@@ -75,7 +81,7 @@ namespace P3D
             /*
             Returns transform from objects space to world space.
             */
-            inline const QTransform& GetTransformToWorldSpace() const { return _toWorldSpace(); }
+            inline const QTransform& GetTransformToWorldSpace() const { return _toWorldSpace.Get(this, _dirty); }
 
             /*
             Changes object transform matrix so that transform to world space == transform.
@@ -85,12 +91,12 @@ namespace P3D
             /*
             Return bounding box in the object space.
             */
-            inline const AABB& GetBoundingBox() const { return _bbox(); }
+            inline const AABB& GetBoundingBox() const { return _bbox.Get(this, _dirty); }
 
             /*
             Return bounding box in the parent's object space.
             */
-            inline const AABB& GetBoundingBoxInParentSpace() const  { return _bboxInPS(); }
+            inline const AABB& GetBoundingBoxInParentSpace() const  { return _bboxInPS.Get(this, _dirty); }
 
             /*
             Return QTransform from object space to parent space.
@@ -109,21 +115,20 @@ namespace P3D
             /*
             Return matrix based transform from objects space to parent space.
             */
-            inline const Transform& GetMatrixTransform() const { return _transform(); }
+            inline const Transform& GetMatrixTransform() const { return _transform.Get(this, _dirty); }
 
             /*
             Return matrix based transform from parent space to object space.
             */
-            inline const Transform& GetInvMatrixTransform() const { return _invTransform(); }
+            inline const Transform& GetInvMatrixTransform() const { return _invTransform.Get(this, _dirty); }
 
             /*
             Says that entity should recalculate bounding box next time its required.
             */
             inline void InvalidateBoundingBox()
             { 
-                _bbox.Invalidate();
-                _bboxInPS.Invalidate();
-                if (_parent) ((Entity*)_parent)->InvalidateBoundingBox();
+                LazyBoundingBox::Invalidate(_dirty);
+                NotifyParentBoundingBox();
             }
 
             /*
@@ -156,6 +161,11 @@ namespace P3D
             */
             inline EntityController* GetController() const {  return _controller; }
 
+            /*
+            Is entity at rest? Sleeping entities are not updated by their parents.
+            */
+            inline bool IsSleeping() const;
+
             /*
             Set the collision model of the entity.
             */
@@ -177,6 +187,27 @@ namespace P3D
             */
             inline void SetMass(Scalar mass) { _mass = mass; }
 
+            /*
+            Enable continuous collision detection for fast moving entity.
+            When entity moves more than motionThreshold during one simulation step
+            its motion is swept with sphere of sweptSphereRadius to prevent tunneling.
+            Zero threshold disables it. Can be changed at any time.
+            See also PhysicalWorld::SetContinuousCollision.
+            */
+            void SetContinuousCollision(Scalar motionThreshold, Scalar sweptSphereRadius);
+
+            /*
+            Return continuous collision parameters.
+            */
+            inline Scalar GetCcdMotionThreshold() const { return _ccdMotionThreshold; }
+            inline Scalar GetCcdSweptSphereRadius() const { return _ccdSweptSphereRadius; }
+
+            /*
+            Sweep entity collision model from its current position to the given one (in world space).
+            Return true and fill result in case something is hit. Entity itself is ignored.
+            */
+            bool Sweep(const QTransform& to, Physics::SweepResult& result) const;
+
         protected:
             /*
             Set's opaque pointer to some controller specific stuff.
@@ -236,7 +267,7 @@ namespace P3D
             /*
             Says that entity should recalculate transform to world space.
             */
-            virtual void InvalidateTransformToWorldSpace() { _toWorldSpace.Invalidate(); }
+            virtual void InvalidateTransformToWorldSpace() { LazyTransformToWorld::Invalidate(_dirty); }
 
             /*
             Call this when you change ObjectTransform to update OpenGL transformation matrix
@@ -244,14 +275,24 @@ namespace P3D
             */
             inline void InvalidateObjectTransform()
             { 
-                _transform.Invalidate();
-                _invTransform.Invalidate();
+                LazyTransform::Invalidate(_dirty); // with inverse and bounding box in parent space
                 InvalidateTransformToWorldSpace();
-                _bboxInPS.Invalidate();
-                if (_parent) ((Entity*)_parent)->InvalidateBoundingBox();
+                NotifyParentBoundingBox();
+            }
+
+            /*
+            Tell parent that bounding box in parent space has changed.
+            Parent collects changed childs and refits its box on the next query,
+            once per frame, so the walk up stops at the first already notified ancestor.
+            */
+            inline void NotifyParentBoundingBox()
+            {
+                if (_parent && !_bboxQueued) QueueBoundingBoxInParent();
             }
 
         private:
+            void QueueBoundingBoxInParent();
+
             struct OpenGLMatrix
             {
                 GLfloat Matrix[4][4];
@@ -295,15 +336,36 @@ namespace P3D
             }
 
         private:
-            Lazy<Entity, Transform> _transform; // ObjectTransform in matrix form
-            Lazy<Entity, Transform> _invTransform;  // _transform ^ -1
-            Lazy<Entity, QTransform> _toWorldSpace; // transform from object space to world space
-            Lazy<Entity, AABB> _bbox; // bounding box in object space
-            Lazy<Entity, AABB> _bboxInPS; // bounding box in parent space
+            // Dirty bits of lazy values
+            enum
+            {
+                Dirty_Transform = 1 << 0,
+                Dirty_InvTransform = 1 << 1,
+                Dirty_TransformToWorld = 1 << 2,
+                Dirty_BoundingBox = 1 << 3,
+                Dirty_BoundingBoxInPS = 1 << 4
+            };
+
+            typedef Lazy<Entity, Transform, &Entity::RecalculateTransform,
+                Dirty_Transform, Dirty_InvTransform | Dirty_BoundingBoxInPS> LazyTransform;
+            typedef Lazy<Entity, Transform, &Entity::RecalculateInvTransform, Dirty_InvTransform> LazyInvTransform;
+            typedef Lazy<Entity, QTransform, &Entity::RecalculateTransformToWorld, Dirty_TransformToWorld> LazyTransformToWorld;
+            typedef Lazy<Entity, AABB, &Entity::RecalculateBoundingBox,
+                Dirty_BoundingBox, Dirty_BoundingBoxInPS> LazyBoundingBox;
+            typedef Lazy<Entity, AABB, &Entity::RecalculateBoundingBoxInPS, Dirty_BoundingBoxInPS> LazyBoundingBoxInPS;
+
+            LazyTransform _transform; // ObjectTransform in matrix form
+            LazyInvTransform _invTransform;  // _transform ^ -1
+            LazyTransformToWorld _toWorldSpace; // transform from object space to world space
+            LazyBoundingBox _bbox; // bounding box in object space
+            LazyBoundingBoxInPS _bboxInPS; // bounding box in parent space
+            mutable DirtyFlags _dirty;
 
             QTransform _objectTransform;
 
             CompoundEntity* _parent; // parent entity
+            AABB _bboxInParent; // box last accounted in the parent's box
+            bool _bboxQueued; // is entity in changed childs of the parent
             World* _parentWorld; // the world this entity is in
 
             uint _lastUpdateTick; // last tick count of the timer
@@ -318,9 +380,24 @@ namespace P3D
 
             SmartPointer<Physics::CollisionModel> _collisionModel;
             Scalar _mass;
+            Scalar _ccdMotionThreshold;
+            Scalar _ccdSweptSphereRadius;
         };
     }
 }
 
+#include "EntityController.h"
+
+namespace P3D
+{
+    namespace World
+    {
+        inline bool Entity::IsSleeping() const
+        {
+            return _controller && _controller->IsSleeping(this);
+        }
+    }
+}
+
 #include "CompoundEntity.h"
 #include "RendererContext.h"
\ No newline at end of file
@@ -4,15 +4,40 @@ namespace P3D
 {
     namespace World
     {
+        /*
+        Listens to activation changes of the entities driven by EntityController.
+        */
+        class EntityControllerListener
+        {
+        public:
+            /*
+            Entity was at rest and starts moving again.
+            */
+            virtual void OnWakeUp(Entity* entity) {}
+
+            /*
+            Entity came to rest. It won't be updated till it wakes up.
+            */
+            virtual void OnFallAsleep(Entity* entity) {}
+        };
+
         /*
         Controls updates of the entities.
         */
         class EntityController :
             public Object,
-            public ObjectWithTags
+            public ObjectWithTags,
+            public Observable<EntityControllerListener, NotThreadSafe>
         {
             friend class Entity;
 
+        public:
+            /*
+            Return true in case the entity is at rest and does not need updates.
+            Sleeping entities are skipped by Entity::Update.
+            */
+            virtual bool IsSleeping(const Entity* entity) const { return false; }
+
         protected:
             /*
             Called when the controller gets assigned to the entity.
@@ -33,6 +58,11 @@ namespace P3D
             Called before first update.
             */
             virtual void Prepare(Entity* entity) {}
+
+            /*
+            Called when physical parameters of prepared entity are changed.
+            */
+            virtual void ParametersChanged(Entity* entity) {}
         };
     }
 }
\ No newline at end of file
@@ -9,4 +9,6 @@
 #include "Camera.h"
 #include "FlyingCamera.h"
 #include "Box.h"
+#include "WorldRecorder.h"
+#include "WorldReplay.h"
 #include "PhysicalWorld.h"
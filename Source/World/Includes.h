@@ -2,6 +2,7 @@
 
 #include "Common/Includes.h"
 #include "Common/ObjectWithTags.h"
+#include "Common/Observable.h"
 #include "Common/TimeCounter.h"
 #include "Common/SmartPointer.h"
 #include "Common/Lazy.h"
@@ -13,6 +13,29 @@ namespace P3D
     {
         class CollisionModel;
 
+        /*
+        Convex sweep query. Model should be convex (not a triangle mesh).
+        */
+        struct SweepQuery
+        {
+            CollisionModel* Model;
+            QTransform From; // in world space
+            QTransform To;
+            const World::Entity* Ignore; // entity to skip (usually the one being moved), can be NULL
+        };
+
+        /*
+        Result of the convex sweep query.
+        */
+        struct SweepResult
+        {
+            bool Hit;
+            Scalar Fraction; // part of the way from From to To passed till the hit
+            Vector Point; // in world space
+            Vector Normal;
+            World::Entity* Entity; // hit entity, NULL for static bodies not belonging to entities
+        };
+
         /*
         Base abstract class for physics sub-system.
         */
@@ -35,10 +58,52 @@ namespace P3D
             */
             virtual void Update(TimeCounter& time) = 0;
 
+            /*
+            Set continuous collision parameters of the entity (see Entity::SetContinuousCollision).
+            Negative values are replaced with ones fitting entity collision model:
+            threshold is half of its smallest size and sphere is slightly smaller than that.
+            Only fast movers should use it, other bodies don't pay for it.
+            */
+            virtual void SetContinuousCollision(World::Entity* entity, 
+                Scalar motionThreshold = -1, Scalar sweptSphereRadius = -1) = 0;
+
+            /*
+            Sweep convex models along the queries paths and return the closest hit of each.
+            Should be called from the thread updating the world.
+            */
+            virtual void ConvexSweepTest(const SweepQuery* queries, SweepResult* results, uint count) = 0;
+
             /*
             PhysicalWorld also acts as class factory for Collision models.
+            Models are shared: asking twice for the model with the same parameters
+            returns the same instance with one more reference added.
+            Caller should release returned model.
             */
             virtual CollisionModel* CreateBoxCollisionModel(Scalar sx, Scalar sy, Scalar sz) = 0;
+
+            /*
+            Shared sphere collision model.
+            */
+            virtual CollisionModel* CreateSphereCollisionModel(Scalar radius) = 0;
+
+            /*
+            Shared capsule collision model aligned along Z axis.
+            'height' is the length of the cylindrical part (without caps).
+            */
+            virtual CollisionModel* CreateCapsuleCollisionModel(Scalar radius, Scalar height) = 0;
+
+            /*
+            Shared convex hull of the points. Points are copied.
+            */
+            virtual CollisionModel* CreateConvexHullCollisionModel(const Vector* points, uint count) = 0;
+
+            /*
+            Shared static triangle mesh. Each three indices make a triangle.
+            Vertices and indices are copied.
+            Only entities with zero (infinite) mass can use it.
+            */
+            virtual CollisionModel* CreateTriangleMeshCollisionModel(const Vector* vertices, uint vertexCount,
+                const uint* indices, uint indexCount) = 0;
         };
     }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "World.h"
 
 #include "Common/Counters.h"
+#include "Common/Profiler.h"
 
 namespace P3D
 {
@@ -29,14 +30,32 @@ namespace P3D
             CompoundEntity::Prepare();
         }
 
-        bool World::Update()
+        void World::PrepareOnFirstUpdate()
         {
             if (_timeCounter.GetTicks() == 0)
             {
                 _timeCounter.Reset();
                 Prepare();
             }
+        }
+
+        bool World::Update()
+        {
+            PrepareOnFirstUpdate();
             _timeCounter.Tick();
+            return UpdateWorld();
+        }
+
+        bool World::Update(float tickTime)
+        {
+            PrepareOnFirstUpdate();
+            _timeCounter.Tick(tickTime);
+            return UpdateWorld();
+        }
+
+        bool World::UpdateWorld()
+        {
+            PROFILE_SCOPE("World.Update");
             if (_physicalWorld) _physicalWorld->Update(_timeCounter);
             return CompoundEntity::Update();
         }
@@ -44,18 +63,22 @@ namespace P3D
         void World::Render(Camera* camera)
         {
             ASSERT(camera != NULL);
+            PROFILE_SCOPE("World.Render");
 
             // activate camera
             _activeCamera = camera;
             camera->LoadCameraTransform();
 
-            // reset counters ;)
-            ClearCounters();
-
             // get camera frustum in world space
             Frustum frustum = _activeCamera->GetFrustum();
             frustum.Transform(_activeCamera->GetTransformToWorldSpace());
 
+            // account boxes of entities moved since the last frame before culling
+            {
+                PROFILE_SCOPE("World.BoundingBoxes");
+                GetBoundingBox();
+            }
+
             // render
             RendererContext context(frustum);
             context.Flags = RF_RenderHelpers;// | RF_RenderAll;
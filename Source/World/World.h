@@ -41,6 +41,12 @@ namespace P3D
             */
             override bool Update();
 
+            /*
+            Update world advancing time by given tick (msecs) instead of measured one.
+            Used to replay recorded sessions.
+            */
+            bool Update(float tickTime);
+
             /*
             Renders world from camera viewpoint.
             */
@@ -75,6 +81,16 @@ namespace P3D
         private:
             void Render(const RendererContext& params) { CompoundEntity::Render(params); } // hide from pubic members
 
+            /*
+            Prepare world on first update.
+            */
+            void PrepareOnFirstUpdate();
+
+            /*
+            Update physics and entities after time has been ticked.
+            */
+            bool UpdateWorld();
+
         private:
             TimeCounter _timeCounter; // counts msecs
             SmartPointer<Camera> _activeCamera;
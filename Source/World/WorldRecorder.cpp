@@ -0,0 +1,91 @@
+#include "Includes.h"
+#include "WorldRecorder.h"
+
+namespace P3D
+{
+    namespace World
+    {
+        Logger WorldRecorder::logger(L"World.Recorder");
+
+        void ReplayFormat::CollectEntities(const CompoundEntity* compound, std::vector<Entity*>& entities)
+        {
+            const CompoundEntity::ChildsContainer& childs = compound->GetChilds();
+            for (CompoundEntity::ChildsContainer::const_iterator it = childs.begin(); it != childs.end(); ++it)
+            {
+                entities.push_back(*it);
+                if ((*it)->GetClass() == Entity::Entity_Compound)
+                    CollectEntities(static_cast<const CompoundEntity*>(*it), entities);
+            }
+        }
+
+        WorldRecorder::WorldRecorder()
+        {
+            _file = NULL;
+            _ticks = 0;
+        }
+
+        WorldRecorder::~WorldRecorder()
+        {
+            Stop();
+        }
+
+        bool WorldRecorder::Start(const String& file, const World* world)
+        {
+            Stop();
+
+            _file = _wfopen(file.c_str(), L"wb");
+            if (!_file)
+            {
+                logger.error() << L"Can't create record file: " << file;
+                return false;
+            }
+            _ticks = 0;
+
+            std::vector<Entity*> entities;
+            ReplayFormat::CollectEntities(world, entities);
+
+            uint32 header[3] = { ReplayFormat::Magic, ReplayFormat::Version, entities.size() };
+            fwrite(header, sizeof(header), 1, _file);
+
+            for (uint i = 0; i < entities.size(); i++)
+            {
+                const QTransform& tr = entities[i]->GetTransform();
+                uint32 cls = entities[i]->GetClass();
+                Scalar data[7] = {
+                    tr.Translation.x, tr.Translation.y, tr.Translation.z,
+                    tr.Rotation.x, tr.Rotation.y, tr.Rotation.z, tr.Rotation.w };
+                fwrite(&cls, sizeof(cls), 1, _file);
+                fwrite(data, sizeof(data), 1, _file);
+            }
+
+            logger.info() << L"Recording to " << file << L", " << entities.size() << L" entities";
+            return true;
+        }
+
+        void WorldRecorder::Stop()
+        {
+            if (!_file) return;
+            fclose(_file);
+            _file = NULL;
+            logger.info() << L"Recorded " << _ticks << L" ticks";
+        }
+
+        void WorldRecorder::RecordEvent(const ReplayEvent& event)
+        {
+            if (!_file) return;
+            byte type = ReplayFormat::Record_Event;
+            fwrite(&type, sizeof(type), 1, _file);
+            fwrite(&event.Type, sizeof(event.Type), 1, _file);
+            fwrite(event.Params, sizeof(event.Params), 1, _file);
+        }
+
+        void WorldRecorder::RecordTick(float tickTime)
+        {
+            if (!_file) return;
+            byte type = ReplayFormat::Record_Tick;
+            fwrite(&type, sizeof(type), 1, _file);
+            fwrite(&tickTime, sizeof(tickTime), 1, _file);
+            _ticks++;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "World.h"
+
+namespace P3D
+{
+    namespace World
+    {
+        /*
+        Input event stored in the record.
+        Meaning of type and params is defined by application.
+        */
+        struct ReplayEvent
+        {
+            uint32 Type;
+            int32 Params[3];
+
+            ReplayEvent(uint32 type = 0, int32 p0 = 0, int32 p1 = 0, int32 p2 = 0)
+                : Type(type)
+            {
+                Params[0] = p0;
+                Params[1] = p1;
+                Params[2] = p2;
+            }
+        };
+
+        namespace ReplayFormat
+        {
+            /*
+            Record file layout:
+                header: magic, version, entities count
+                initial state: entity class and transform for each entity in depth-first order
+                records: Record_Event or Record_Tick followed by its data
+            Events belong to the next tick record.
+            */
+            const uint32 Magic = 0x52443350; // "P3DR"
+            const uint32 Version = 1;
+
+            enum RecordType
+            {
+                Record_Tick = 1,    // float tick time in msecs
+                Record_Event = 2    // ReplayEvent
+            };
+
+            /*
+            Collect all world entities (without world itself) in depth-first order.
+            */
+            void CollectEntities(const CompoundEntity* compound, std::vector<Entity*>& entities);
+        }
+
+        /*
+        Records world session to the file: initial entities state,
+        tick times and input events. Recorded file can be played by WorldReplay
+        to get exactly the same simulation without rendering.
+        */
+        class WorldRecorder
+        {
+        public:
+            WorldRecorder();
+            ~WorldRecorder();
+
+            /*
+            Create record file and write initial state of world entities.
+            Should be called after the world is built, before the first update.
+            Return false in case file can't be created.
+            */
+            bool Start(const String& file, const World* world);
+
+            /*
+            Close the file.
+            */
+            void Stop();
+
+            bool IsRecording() const { return _file != NULL; }
+
+            /*
+            Record input event. Application should handle it right after recording.
+            */
+            void RecordEvent(const ReplayEvent& event);
+
+            /*
+            Record time of the world update that just happened.
+            */
+            void RecordTick(float tickTime);
+
+            /*
+            Return count of ticks recorded.
+            */
+            uint GetTicks() const { return _ticks; }
+
+        private:
+            FILE* _file;
+            uint _ticks;
+
+            static Logger logger;
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "Includes.h"
+#include "WorldReplay.h"
+
+#include "Common/Counters.h"
+
+namespace P3D
+{
+    namespace World
+    {
+        Logger WorldReplay::logger(L"World.Replay");
+
+        WorldReplay::WorldReplay()
+        {
+            _file = NULL;
+            _world = NULL;
+        }
+
+        WorldReplay::~WorldReplay()
+        {
+            Close();
+        }
+
+        void WorldReplay::Close()
+        {
+            if (!_file) return;
+            fclose(_file);
+            _file = NULL;
+        }
+
+        bool WorldReplay::Start(const String& file, World* world)
+        {
+            Close();
+            _world = world;
+            _stats = ReplayStats();
+
+            _file = _wfopen(file.c_str(), L"rb");
+            if (!_file)
+            {
+                logger.error() << L"Can't open record file: " << file;
+                return false;
+            }
+
+            uint32 header[3];
+            if (fread(header, sizeof(header), 1, _file) != 1
+                || header[0] != ReplayFormat::Magic || header[1] != ReplayFormat::Version)
+            {
+                logger.error() << L"Not a record file or unsupported version: " << file;
+                Close();
+                return false;
+            }
+
+            if (!ApplyInitialState(header[2]))
+            {
+                Close();
+                return false;
+            }
+
+            logger.info() << L"Replaying " << file << L", " << header[2] << L" entities";
+            return true;
+        }
+
+        bool WorldReplay::ApplyInitialState(uint count)
+        {
+            std::vector<Entity*> entities;
+            ReplayFormat::CollectEntities(_world, entities);
+
+            for (uint i = 0; i < count; i++)
+            {
+                uint32 cls;
+                Scalar data[7];
+                if (fread(&cls, sizeof(cls), 1, _file) != 1 || fread(data, sizeof(data), 1, _file) != 1)
+                {
+                    logger.error() << L"Record file is truncated";
+                    return false;
+                }
+
+                // entities recorded after the last one we have (e.g. requiring renderer) are skipped
+                if (i >= entities.size()) continue;
+
+                if (entities[i]->GetClass() != (Entity::EntityClass)cls)
+                {
+                    logger.error() << L"World doesn't match the record: entity " << i
+                        << L" has class " << entities[i]->GetClass() << L" but " << cls << L" is recorded";
+                    return false;
+                }
+
+                QTransform tr;
+                tr.Translation.Set(data[0], data[1], data[2]);
+                tr.Rotation.Set(data[3], data[4], data[5], data[6]);
+                entities[i]->SetTransform(tr);
+            }
+
+            if (count != entities.size())
+            {
+                logger.warn() << L"World has " << entities.size() << L" entities but "
+                    << count << L" are recorded, simulation may differ";
+            }
+            return true;
+        }
+
+        bool WorldReplay::Step()
+        {
+            if (!_file) return false;
+
+            byte type;
+            while (fread(&type, sizeof(type), 1, _file) == 1)
+            {
+                if (type == ReplayFormat::Record_Event)
+                {
+                    ReplayEvent event;
+                    if (fread(&event.Type, sizeof(event.Type), 1, _file) != 1
+                        || fread(event.Params, sizeof(event.Params), 1, _file) != 1)
+                        break;
+                    DispatchEvent(&ReplayListener::OnReplayEvent, event);
+                }
+                else if (type == ReplayFormat::Record_Tick)
+                {
+                    float tickTime;
+                    if (fread(&tickTime, sizeof(tickTime), 1, _file) != 1) break;
+
+                    _timer.Reset();
+                    _world->Update(tickTime);
+                    _timer.Tick();
+
+                    double updateTime = _timer.GetLastTick();
+                    double physicsTime = g_PhysicsStepTime.Get() / 1000.0;
+                    _stats.Ticks++;
+                    _stats.SimulatedTime += tickTime;
+                    _stats.UpdateTime += updateTime;
+                    if (updateTime > _stats.MaxUpdateTime) _stats.MaxUpdateTime = updateTime;
+                    _stats.PhysicsTime += physicsTime;
+                    _stats.BroadphaseTime += g_PhysicsBroadphaseTime.Get() / 1000.0;
+                    _stats.NarrowphaseTime += g_PhysicsNarrowphaseTime.Get() / 1000.0;
+                    _stats.SolverTime += g_PhysicsSolverTime.Get() / 1000.0;
+                    _stats.IntegrationTime += g_PhysicsIntegrationTime.Get() / 1000.0;
+                    if (updateTime > physicsTime) _stats.EntitiesTime += updateTime - physicsTime;
+
+                    // physical world publishes timings only when it steps
+                    g_PhysicsStepTime.Set(0);
+                    g_PhysicsBroadphaseTime.Set(0);
+                    g_PhysicsNarrowphaseTime.Set(0);
+                    g_PhysicsSolverTime.Set(0);
+                    g_PhysicsIntegrationTime.Set(0);
+                    return true;
+                }
+                else
+                {
+                    logger.error() << L"Unknown record type " << (int)type;
+                    break;
+                }
+            }
+
+            Close();
+            return false;
+        }
+
+        const ReplayStats& WorldReplay::Run()
+        {
+            while (Step());
+
+            logger.info() << L"Replay finished: " << _stats.Ticks << L" ticks, "
+                << _stats.SimulatedTime << L" ms simulated";
+            if (_stats.Ticks == 0) return _stats;
+
+            logger.info() << L"Update: total " << _stats.UpdateTime << L" ms, average "
+                << _stats.UpdateTime / _stats.Ticks << L" ms, max " << _stats.MaxUpdateTime << L" ms";
+            logger.info() << L"Physics: total " << _stats.PhysicsTime
+                << L" ms (broadphase " << _stats.BroadphaseTime
+                << L", narrowphase " << _stats.NarrowphaseTime
+                << L", solver " << _stats.SolverTime
+                << L", integration " << _stats.IntegrationTime << L")";
+            logger.info() << L"Entities: total " << _stats.EntitiesTime << L" ms";
+            return _stats;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "WorldRecorder.h"
+
+namespace P3D
+{
+    namespace World
+    {
+        /*
+        Receives recorded input events during replay.
+        */
+        class ReplayListener
+        {
+        public:
+            virtual void OnReplayEvent(const ReplayEvent& event) {}
+        };
+
+        /*
+        Timings of the replay. Times are in msecs.
+        */
+        struct ReplayStats
+        {
+            uint Ticks;
+            double SimulatedTime;   // sum of recorded ticks
+            double UpdateTime;      // wall time spent in World::Update
+            double MaxUpdateTime;   // slowest World::Update
+            double PhysicsTime;     // whole physics steps
+            double BroadphaseTime;
+            double NarrowphaseTime;
+            double SolverTime;
+            double IntegrationTime;
+            double EntitiesTime;    // UpdateTime without physics
+
+            ReplayStats() { memset(this, 0, sizeof(ReplayStats)); }
+        };
+
+        /*
+        Plays session recorded by WorldRecorder.
+        Drives world with recorded ticks and dispatches recorded input events,
+        measuring time spent in updates. Doesn't need rendering so can be run headless.
+        */
+        class WorldReplay :
+            public Observable<ReplayListener, NotThreadSafe>
+        {
+        public:
+            WorldReplay();
+            ~WorldReplay();
+
+            /*
+            Open record file and apply recorded initial state to the world entities.
+            World should be built the same way it was when recorded.
+            Return false in case file can't be read or world doesn't match the record.
+            */
+            bool Start(const String& file, World* world);
+
+            /*
+            Dispatch events of next tick and update world with recorded tick time.
+            Return false when record is over.
+            */
+            bool Step();
+
+            /*
+            Play all remaining ticks, write timings to the log and return them.
+            */
+            const ReplayStats& Run();
+
+            /*
+            Return timings collected so far.
+            */
+            const ReplayStats& GetStats() const { return _stats; }
+
+        private:
+            FILE* _file;
+            World* _world;
+            ReplayStats _stats;
+            TimeCounter _timer;
+
+            void Close();
+            bool ApplyInitialState(uint count);
+
+            static Logger logger;
+        };
+    }
+}
\ No newline at end of file